@@ -0,0 +1,65 @@
+#include <filesystem>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "AtomicFile.hpp"
+
+bool WriteFileAtomic(const std::string& path, const std::string& data) {
+    return WriteFileAtomic(path, [&data] (FILE* fd) {
+        return fwrite(data.data(), 1, data.size(), fd) == data.size();
+    });
+}
+
+bool WriteFileAtomic(const std::string& path, const std::function<bool(FILE*)>& write) {
+    std::string tmp = path + ".tmp";
+    FILE* fd = fopen(tmp.c_str(), "wb");
+    if (fd == nullptr) {
+        return false;
+    }
+    bool ok = write(fd) && fflush(fd) == 0;
+#ifdef WIN32
+    ok = ok && _commit(_fileno(fd)) == 0;
+#else
+    ok = ok && fsync(fileno(fd)) == 0;
+#endif
+    ok = fclose(fd) == 0 && ok;
+    std::error_code ec;
+    if (!ok) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+#ifndef WIN32
+    // the rename itself only survives a power loss once the directory is synced
+    std::filesystem::path dir = std::filesystem::path(path).parent_path();
+    int dir_fd = open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+#endif
+    return true;
+}
+
+void RotateBackups(const std::string& path, int count) {
+    std::error_code ec;
+    if (count <= 0 || !std::filesystem::exists(path, ec)) {
+        return;
+    }
+    for (int i = count - 1; i >= 1; i--) {
+        std::string from = path + "." + std::to_string(i);
+        if (std::filesystem::exists(from, ec)) {
+            std::filesystem::rename(from, path + "." + std::to_string(i + 1), ec);
+        }
+    }
+    std::filesystem::copy_file(path, path + ".1", std::filesystem::copy_options::overwrite_existing, ec);
+}
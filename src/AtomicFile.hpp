@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <string>
+
+// replaces path with data through a temporary file that is flushed to disk and renamed over it,
+// a crash leaves either the old or the new contents but never a truncated file
+bool WriteFileAtomic(const std::string& path, const std::string& data);
+// same, for files too big to build in memory, write() fills the temporary file and returns false to give up
+bool WriteFileAtomic(const std::string& path, const std::function<bool(FILE*)>& write);
+
+// shifts path.1 .. path.(count-1) up by one and copies path to path.1, the oldest backup falls off
+void RotateBackups(const std::string& path, int count);
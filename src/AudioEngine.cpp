@@ -0,0 +1,405 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "AudioEngine.hpp"
+
+// the mixer reports the first period mixed after a triggered sound started, that period holds its first samples.
+// it also keeps the peak of each mixed period for the level meters
+static std::atomic<bool> probe_armed{false};
+static std::atomic<int64_t> probe_mixed_at{0};
+static std::atomic<float> mixed_peak{0.0f};
+
+static void MixedProbe(void* buffer, unsigned int frames) {
+    if (probe_armed.exchange(false)) {
+        probe_mixed_at = std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+    // the mixer works in stereo floats
+    const float* samples = (const float*)buffer;
+    float peak = 0.0f;
+    for (unsigned int i = 0; i < frames * 2; i++) {
+        peak = std::max(peak, std::fabs(samples[i]));
+    }
+    mixed_peak.store(peak, std::memory_order_relaxed);
+}
+
+AudioEngine::AudioEngine(SoundLibrary& library) : _library(library) {
+    _queue = new Slot[QUEUE_SIZE];
+    for (size_t i = 0; i < QUEUE_SIZE; i++) {
+        _queue[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    _thread = std::thread(&AudioEngine::work, this);
+}
+
+AudioEngine::~AudioEngine() {
+    stop();
+    delete[] _queue;
+}
+
+void AudioEngine::stop() {
+    _stopping = true;
+    notify();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    std::lock_guard<std::mutex> guard(_opened_lock);
+    for (auto& o : _opened) {
+        if (IsMusicReady(o.music)) {
+            UnloadMusicStream(o.music);
+            ConfiguredMusic::ReleasePreloaded(o.preloaded_bytes);
+        }
+    }
+    _opened.clear();
+}
+
+bool AudioEngine::post(const Batch& batch) {
+    size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &_queue[pos & (QUEUE_SIZE - 1)];
+        size_t seq = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = _enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+    slot->batch = batch;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    _has_commands = true;
+    notify();
+    return true;
+}
+
+// not notified under mutex(), which the UI may be holding. a wakeup lost to that race while playing is caught after
+// one PERIOD, an idle engine checks for work under _sleep_lock so it can't miss one
+void AudioEngine::notify() {
+    {
+        std::lock_guard<std::mutex> guard(_sleep_lock);
+    }
+    _cv.notify_one();
+    _sleep_cv.notify_one();
+}
+
+void AudioEngine::trigger(SoundId id, Clock::time_point pressed, bool counted) {
+    Batch batch;
+    batch.sent = pressed;
+    batch.count = 1;
+    batch.commands[0] = {counted ? Command::Play : Command::Continue, id, "", 0.0f};
+    if (!post(batch)) {
+        TraceLog(LOG_WARNING, "Audio engine queue is full, dropped a trigger.");
+    }
+}
+
+void AudioEngine::open(SoundId id) {
+    ConfiguredMusic* music = _library.get(id);
+    if (music == nullptr || music->loaded || music->opening || music->load_failed || !_open) {
+        return;
+    }
+    music->opening = true;
+    _open(id, _library.pathOf(id), music->preload, music->metadata);
+}
+
+void AudioEngine::opened(SoundLoader::Opened& opened) {
+    {
+        std::lock_guard<std::mutex> guard(_opened_lock);
+        _opened.push_back(opened);
+        _has_opened = true;
+    }
+    notify();
+}
+
+// caller holds _lock
+void AudioEngine::installOpened() {
+    std::vector<SoundLoader::Opened> opened;
+    {
+        std::lock_guard<std::mutex> guard(_opened_lock);
+        opened.swap(_opened);
+        _has_opened = false;
+    }
+    for (auto& o : opened) {
+        ConfiguredMusic* music = _library.get(o.id);
+        bool ready = IsMusicReady(o.music);
+        if (music == nullptr || music->loaded) {
+            // removed meanwhile, or opened twice
+            if (ready) {
+                UnloadMusicStream(o.music);
+                ConfiguredMusic::ReleasePreloaded(o.preloaded_bytes);
+            }
+            music = nullptr;
+        } else if (!ready) {
+            music->opening = false;
+            music->load_failed = true;
+            TraceLog(LOG_ERROR, "Failed to open sound file: \"%s\"", o.path.c_str());
+        } else {
+            music->Adopt(o.music, o.preloaded_bytes);
+        }
+        for (size_t i = 0; i < _pending.size();) {
+            Pending p = _pending[i];
+            if (p.id != o.id) {
+                i++;
+                continue;
+            }
+            _pending.erase(_pending.begin() + i);
+            // only if nothing replaced or stopped it while it was opening
+            bool wanted = o.id == _current_id || std::find(_layers.begin(), _layers.end(), o.id) != _layers.end();
+            if (music != nullptr && music->loaded && wanted) {
+                music->Start(p.counted);
+                prime(music, p.sent);
+            }
+        }
+    }
+    _wake();
+}
+
+// caller holds _lock. fills a sound that just started now rather than on the next period
+void AudioEngine::prime(ConfiguredMusic* music, Clock::time_point sent) {
+    UpdateMusicStream(music->music);
+    probe_mixed_at = 0;
+    probe_armed = true;
+    _probe_pending = true;
+    _probe_pressed = sent;
+}
+
+// caller holds _lock
+void AudioEngine::runCommands() {
+    _has_commands = false;
+    while (true) {
+        Slot* slot = &_queue[_dequeue_pos & (QUEUE_SIZE - 1)];
+        if (slot->sequence.load(std::memory_order_acquire) != _dequeue_pos + 1) {
+            break;
+        }
+        run(slot->batch);
+        slot->sequence.store(_dequeue_pos + QUEUE_SIZE, std::memory_order_release);
+        _dequeue_pos++;
+    }
+    _wake();
+}
+
+// caller holds _lock
+SoundId AudioEngine::resolve(const Command& command) {
+    if (command.id.valid() || command.target[0] == 0) {
+        return command.id;
+    }
+    if (strspn(command.target, "0123456789") == strlen(command.target)) {
+        size_t i = strtoul(command.target, nullptr, 10);
+        const std::vector<SoundId>& order = _library.order();
+        return i < order.size() ? order[i] : SoundId();
+    }
+    return _library.findByName(command.target);
+}
+
+// caller holds _lock
+void AudioEngine::run(const Batch& batch) {
+    bool replaced = false;
+    for (unsigned int i = 0; i < batch.count && i < MAX_BATCH; i++) {
+        const Command& c = batch.commands[i];
+        if (c.kind == Command::MasterVolume) {
+            _master_volume = std::clamp(c.value, 0.0f, 1.0f);
+            _master_volume_changed = true;
+            SetMasterVolume(_master_volume);
+            continue;
+        }
+        SoundId id = resolve(c);
+        ConfiguredMusic* music = _library.get(id);
+        ConfiguredMusic* current = this->current();
+        if (c.kind == Command::Stop && !id.valid() && c.target[0] == 0) {
+            if (current != nullptr && current->loaded) {
+                current->Stop();
+            }
+            for (SoundId layer : _layers) {
+                if (ConfiguredMusic* m = _library.get(layer)) {
+                    m->Stop();
+                }
+            }
+            _layers.clear();
+            _pending.clear();
+            continue;
+        }
+        if (music == nullptr) {
+            TraceLog(LOG_DEBUG, "Audio engine: no sound \"%s\".", c.target);
+            continue;
+        }
+        if (c.kind == Command::Volume) {
+            music->Volume(std::clamp(c.value, 0.0f, 2.0f));
+        } else if (c.kind == Command::Stop) {
+            music->Stop();
+            _layers.erase(std::remove(_layers.begin(), _layers.end(), id), _layers.end());
+            _pending.erase(std::remove_if(_pending.begin(), _pending.end(), [id] (const Pending& p) {
+                return p.id == id;
+            }), _pending.end());
+        } else if (!replaced) {
+            // the first play takes over from whatever was playing
+            replaced = true;
+            if (current != nullptr && current->loaded) {
+                current->Stop();
+            }
+            for (SoundId layer : _layers) {
+                ConfiguredMusic* m = _library.get(layer);
+                if (m != nullptr && m != music) {
+                    m->Stop();
+                }
+            }
+            _layers.clear();
+            _current_id = id;
+            _ended = false;
+            _triggered = id;
+        } else if (id != _current_id && std::find(_layers.begin(), _layers.end(), id) == _layers.end()) {
+            _layers.push_back(id);
+        }
+        if (c.kind != Command::Play && c.kind != Command::Continue) {
+            continue;
+        }
+        bool counted = c.kind == Command::Play;
+        if (!music->loaded) {
+            // started once the loader has opened it, the latency includes the open
+            if (music->load_failed) {
+                TraceLog(LOG_WARNING, "Audio engine: \"%s\" can't be opened.", music->name.c_str());
+                continue;
+            }
+            _pending.push_back({id, batch.sent, counted});
+            open(id);
+            continue;
+        }
+        music->Start(counted);
+        prime(music, batch.sent);
+    }
+}
+
+// caller holds _lock. a seqlock, readers copy _snapshot and retry if the sequence moved meanwhile
+void AudioEngine::publish() {
+    unsigned int sequence = _snapshot_sequence.load(std::memory_order_relaxed);
+    _snapshot_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ConfiguredMusic* current = this->current();
+    bool loaded = current != nullptr && current->loaded;
+    _snapshot.current = current != nullptr ? _current_id : SoundId();
+    _snapshot.playing = loaded && IsMusicStreamPlaying(current->music);
+    _snapshot.position = loaded ? current->Tell() : 0.0f;
+    _snapshot.length = current != nullptr ? current->length : 0.0f;
+    _snapshot.level = mixed_peak.load(std::memory_order_relaxed);
+    _snapshot.master_volume = GetMasterVolume();
+    _snapshot.library_revision = _library.revision();
+    _snapshot_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+AudioEngine::Snapshot AudioEngine::snapshot() const {
+    Snapshot snapshot;
+    unsigned int sequence;
+    do {
+        sequence = _snapshot_sequence.load(std::memory_order_acquire);
+        memcpy((void*)&snapshot, (const void*)&_snapshot, sizeof(snapshot));
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) != 0 || sequence != _snapshot_sequence.load(std::memory_order_relaxed));
+    return snapshot;
+}
+
+// caller holds _lock. layers that were removed, unloaded or reached their end are dropped
+void AudioEngine::serviceLayers(float period) {
+    for (size_t i = _layers.size(); i > 0; i--) {
+        ConfiguredMusic* music = _library.get(_layers[i - 1]);
+        // a layer waiting for its decoder is kept until it is installed
+        bool keep = music != nullptr && _layers[i - 1] != _current_id && (music->opening || (music->loaded && IsMusicStreamPlaying(music->music)));
+        if (keep && music->loaded) {
+            UpdateMusicStream(music->music);
+            if (music->ShouldEnd(period)) {
+                music->Stop();
+                keep = music->repeating;
+                if (keep) {
+                    music->Start();
+                }
+            }
+        }
+        if (!keep) {
+            _layers.erase(_layers.begin() + (i - 1));
+        }
+    }
+}
+
+// caller holds _lock
+void AudioEngine::checkLatencyProbe() {
+    int64_t mixed_at = probe_mixed_at;
+    if (!_probe_pending || mixed_at == 0) {
+        return;
+    }
+    _probe_pending = false;
+    Clock::time_point mixed = Clock::time_point(Clock::duration(mixed_at));
+    _latency.last_ms = std::chrono::duration<float, std::milli>(mixed - _probe_pressed).count();
+    _latency.max_ms = std::max(_latency.max_ms, _latency.last_ms);
+    _latency.total_ms += _latency.last_ms;
+    _latency.count++;
+    _latency.last_mixed = mixed;
+    TraceLog(LOG_DEBUG, "Trigger to first mixed sample: %.2f ms", _latency.last_ms);
+}
+
+// caller holds _lock. nothing is playing and no trigger is being measured
+bool AudioEngine::idle() {
+    ConfiguredMusic* current = this->current();
+    bool playing = current != nullptr && current->loaded && IsMusicStreamPlaying(current->music);
+    return !playing && _layers.empty() && !_probe_pending;
+}
+
+void AudioEngine::work() {
+    const float period = std::chrono::duration<float>(PERIOD).count();
+    Clock::time_point last_wake = Clock::now();
+    std::unique_lock<std::mutex> guard(_lock);
+    while (!_stopping) {
+        // the device is opened after the engine starts, processors stay attached when it is reopened
+        if (!_probe_attached && IsAudioDeviceReady()) {
+            AttachAudioMixedProcessor(MixedProbe);
+            _probe_attached = true;
+        }
+        if (_has_commands) {
+            runCommands();
+        }
+        if (_has_opened) {
+            installOpened();
+        }
+        checkLatencyProbe();
+        serviceLayers(period);
+        // looked up every period, main may have removed it while the lock was released
+        ConfiguredMusic* current = this->current();
+        if (current != nullptr && current->loaded) {
+#if !PRODUCTION_BUILD
+            Clock::time_point tick_start = Clock::now();
+#endif
+            UpdateMusicStream(current->music);
+            bool playing = IsMusicStreamPlaying(current->music);
+            if (playing && current->ShouldEnd(period)) {
+                current->Stop();
+                if (current->repeating) {
+                    current->Start();
+                } else {
+                    _ended = true;
+                    _wake();
+                }
+            } else if (playing && _wake_for_progress && Clock::now() - last_wake >= PROGRESS_WAKE_PERIOD) {
+                last_wake = Clock::now();
+                _wake();
+            }
+#if !PRODUCTION_BUILD
+            float tick_ms = std::chrono::duration<float, std::milli>(Clock::now() - tick_start).count();
+            float worst = _worst_tick_ms.load();
+            while (tick_ms > worst && !_worst_tick_ms.compare_exchange_weak(worst, tick_ms)) {}
+#endif
+        }
+        publish();
+        if (idle()) {
+            guard.unlock();
+            {
+                std::unique_lock<std::mutex> sleep(_sleep_lock);
+                _sleep_cv.wait(sleep, [this] { return _stopping || _has_commands || _has_opened || _resumed; });
+                _resumed = false;
+            }
+            guard.lock();
+        } else {
+            _cv.wait_for(guard, PERIOD, [this] { return _stopping || _has_commands || _has_opened; });
+        }
+    }
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ConfiguredMusic.hpp"
+#include "SoundLibrary.hpp"
+#include "SoundLoader.hpp"
+
+// keeps the current sound's stream fed on its own thread, so playback doesn't depend on the frame loop.
+// the UI thread holds mutex() only while it changes sounds or the list, the engine services the stream in between.
+// decoders are never opened under mutex(), the sound loader opens them and the engine installs the streams.
+// trigger() and post() start sounds from any thread without waiting for the frame loop.
+class AudioEngine {
+    public:
+    static constexpr auto PERIOD = std::chrono::milliseconds(10);
+    // how often an idle window is woken up to move the progress slider of a playing sound
+    static constexpr auto PROGRESS_WAKE_PERIOD = std::chrono::milliseconds(66);
+    using Clock = std::chrono::steady_clock;
+    struct Latency {
+        float last_ms=0.0f, max_ms=0.0f, total_ms=0.0f;
+        unsigned int count=0;
+        Clock::time_point last_mixed; // when the last measured trigger's first samples were mixed
+    };
+    struct Command {
+        enum Kind : unsigned char {
+            Play, // restarts the sound, plays in the first replace the current one and its layers
+            Continue, // like Play for the next sound of a sequence, not counted as a play
+            Stop, // stops the sound, or everything without a target
+            Volume, // the sound's volume, 0 to 2
+            MasterVolume, // 0 to 1
+        } kind;
+        SoundId id; // when invalid the engine looks up target instead
+        char target[96]; // position in the list or a sound's name, empty for none
+        float value;
+    };
+    // commands applied together in one period, the sounds played by a batch start on the same mixed period
+    static constexpr size_t MAX_BATCH = 16;
+    struct Batch {
+        Clock::time_point sent; // latency is measured from here
+        unsigned int count=0;
+        Command commands[MAX_BATCH];
+    };
+    static constexpr size_t QUEUE_SIZE = 64; // must be a power of two
+    // what is playing, republished every period for readers that must not wait on mutex()
+    struct Snapshot {
+        SoundId current;
+        bool playing=false;
+        float position=0.0f, length=0.0f; // seconds
+        float level=0.0f; // peak of the last mixed period, before the master volume
+        float master_volume=1.0f;
+        uint32_t library_revision=0;
+    };
+    private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        Batch batch;
+    };
+    // a play that waits for the sound loader to open the sound
+    struct Pending {
+        SoundId id;
+        Clock::time_point sent;
+        bool counted;
+    };
+    SoundLibrary& _library;
+    std::thread _thread;
+    std::mutex _lock;
+    std::condition_variable _cv;
+    // with nothing to feed the engine sleeps on _sleep_cv instead, without a timeout. _sleep_lock is only held
+    // around the check, so waking it never waits on the UI holding _lock
+    std::mutex _sleep_lock;
+    std::condition_variable _sleep_cv;
+    std::atomic<bool> _resumed{false};
+    // only the id is kept, the UI removes and releases entries between periods
+    SoundId _current_id;
+    std::function<void()> _wake = WakeEventWaiting;
+    std::function<void(SoundId, const std::string&, bool, const SoundMetadata&)> _open;
+    std::atomic<bool> _stopping{false}, _ended{false}, _wake_for_progress{false};
+    // bounded multi-producer queue like the console's, posting never waits for the UI to release mutex()
+    Slot* _queue;
+    std::atomic<size_t> _enqueue_pos{0};
+    size_t _dequeue_pos=0;
+    std::atomic<bool> _has_commands{false};
+    SoundId _triggered;
+    std::vector<Pending> _pending;
+    // streams handed in by the sound loader, installed on the next period
+    std::mutex _opened_lock;
+    std::vector<SoundLoader::Opened> _opened;
+    std::atomic<bool> _has_opened{false};
+    // played alongside the current sound by the same batch, serviced until they end
+    std::vector<SoundId> _layers;
+    float _master_volume=1.0f;
+    bool _master_volume_changed=false;
+    bool _probe_attached=false, _probe_pending=false;
+    Clock::time_point _probe_pressed;
+    Latency _latency;
+    std::atomic<unsigned int> _snapshot_sequence{0}; // odd while _snapshot is being written
+    Snapshot _snapshot;
+#if !PRODUCTION_BUILD
+    std::atomic<float> _worst_tick_ms{0.0f};
+#endif
+    // caller holds _lock. null once the current sound is removed
+    ConfiguredMusic* current() const {
+        return _library.get(_current_id);
+    }
+    void work();
+    void runCommands();
+    void run(const Batch& batch);
+    SoundId resolve(const Command& command);
+    void installOpened();
+    bool idle();
+    void notify();
+    void prime(ConfiguredMusic* music, Clock::time_point sent);
+    void serviceLayers(float period);
+    void checkLatencyProbe();
+    void publish();
+    public:
+    AudioEngine(SoundLibrary& library);
+    ~AudioEngine();
+    std::mutex& mutex() {
+        return _lock;
+    }
+    // caller holds mutex()
+    void setCurrent(SoundId id) {
+        ConfiguredMusic* music = _library.get(id);
+        if (music == nullptr) {
+            id = SoundId();
+        }
+        if (id != _current_id) {
+            _ended = false;
+        }
+        _current_id = id;
+        // the UI may have resumed it, it has to be fed again
+        if (music != nullptr && music->loaded && IsMusicStreamPlaying(music->music)) {
+            _resumed = true;
+            notify();
+        }
+        // an idle engine doesn't republish, list and volume changes still have to reach the snapshot
+        publish();
+    }
+    // caller holds mutex(). how the owner of the sounds is woken up, the window's event wait by default
+    void setWake(std::function<void()> wake) {
+        _wake = wake;
+    }
+    // caller holds mutex(). how decoders are opened, SoundLoader::open() normally
+    void setOpener(std::function<void(SoundId, const std::string&, bool, const SoundMetadata&)> open) {
+        _open = open;
+    }
+    // caller holds mutex(). has the sound opened unless it is open, being opened or failed before
+    void open(SoundId id);
+    // any thread. takes a stream the sound loader opened, the engine installs it and starts plays that waited on it
+    void opened(SoundLoader::Opened& opened);
+    // any thread, never blocks. false if the queue is full and the batch was dropped
+    bool post(const Batch& batch);
+    // any thread. restarts the sound and makes it the current one, pressed is when the key went down.
+    // counted is false for sequence advances, which aren't plays a user asked for
+    void trigger(SoundId id, Clock::time_point pressed, bool counted=true);
+    // caller holds mutex(). the sound last made current by a command since the previous call, if any
+    bool takeTriggered(SoundId& id) {
+        if (!_triggered.valid()) {
+            return false;
+        }
+        id = _triggered;
+        _triggered = SoundId();
+        return true;
+    }
+    // caller holds mutex(). the master volume last set by a command since the previous call, if any
+    bool takeMasterVolume(float& volume) {
+        if (!_master_volume_changed) {
+            return false;
+        }
+        volume = _master_volume;
+        _master_volume_changed = false;
+        return true;
+    }
+    // caller holds mutex(). time from a trigger to its first samples being mixed, without the device's own buffering
+    const Latency& latency() const {
+        return _latency;
+    }
+    // any thread, never blocks. a consistent copy of the state published last period
+    Snapshot snapshot() const;
+    // true once each time the current sound reaches its end without looping
+    bool takeEnded() {
+        return _ended.exchange(false);
+    }
+    // while set, the window is woken up periodically as long as the current sound is playing
+    void wakeForProgress(bool enable) {
+        _wake_for_progress = enable;
+    }
+#if !PRODUCTION_BUILD
+    // longest time one period spent servicing the stream since the last call, for the frame profiler
+    float takeWorstTick() {
+        return _worst_tick_ms.exchange(0.0f);
+    }
+#endif
+    // must be called before the audio device is closed
+    void stop();
+};
@@ -0,0 +1,90 @@
+#include <algorithm>
+
+#include "../thirdparty/raylib-5.0/src/raylib.h"
+#include "AtomicFile.hpp"
+#include "Autosaver.hpp"
+#include "JsonConfig.hpp"
+
+void Autosaver::start(std::function<void()> wake) {
+    _wake = wake;
+    _stopping = false;
+    _thread = std::thread(&Autosaver::work, this);
+}
+
+void Autosaver::stop() {
+    if (!_thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stopping = true;
+        _has_document = false;
+        _document = nlohmann::json();
+    }
+    _cv.notify_all();
+    _thread.join();
+}
+
+void Autosaver::touch() {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _last_change = Clock::now();
+        if (!_changed) {
+            _changed = true;
+            _first_change = _last_change;
+        }
+    }
+    _cv.notify_all();
+}
+
+void Autosaver::save(nlohmann::json document) {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _document = std::move(document);
+        _has_document = true;
+    }
+    _cv.notify_all();
+}
+
+void Autosaver::work() {
+    std::unique_lock<std::mutex> guard(_lock);
+    while (!_stopping) {
+        if (_has_document) {
+            nlohmann::json document = std::move(_document);
+            _has_document = false;
+            guard.unlock();
+            write(document);
+            guard.lock();
+            continue;
+        }
+        if (!_changed) {
+            _cv.wait(guard);
+            continue;
+        }
+        Clock::time_point due_at = std::min(_last_change + QUIET_PERIOD, _first_change + MAX_DELAY);
+        if (Clock::now() < due_at) {
+            _cv.wait_until(guard, due_at);
+            continue;
+        }
+        _changed = false;
+        _due = true;
+        if (_wake) {
+            _wake();
+        }
+    }
+}
+
+void Autosaver::write(const nlohmann::json& document) {
+    Clock::time_point start = Clock::now();
+    if (!_backed_up || start - _last_backup >= BACKUP_PERIOD) {
+        RotateBackups(_filename, BACKUPS);
+        _backed_up = true;
+        _last_backup = start;
+    }
+    if (!JsonConfig::Write(_filename, document)) {
+        TraceLog(LOG_WARNING, "Autosave: failed to write %s", _filename.c_str());
+        return;
+    }
+    TraceLog(LOG_DEBUG, "Autosave: wrote %s in %.1f ms", _filename.c_str(),
+        std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+}
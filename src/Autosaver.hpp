@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "../include/nlohmann/json.hpp"
+
+// saves a json file in the background while the board runs.
+// the UI thread calls touch() when something that ends up in the file may have changed,
+// once changes have been quiet for QUIET_PERIOD (or kept coming for MAX_DELAY) the thread wakes
+// the UI thread, which sees due() and hands over a copy of the document with save().
+// dumping and writing happen on the thread, the file is replaced atomically and the copy it
+// replaces is kept as filename.1 .. filename.BACKUPS, rotated once per session and every BACKUP_PERIOD.
+class Autosaver {
+    public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr auto QUIET_PERIOD = std::chrono::seconds(2);
+    static constexpr auto MAX_DELAY = std::chrono::seconds(30);
+    static constexpr auto BACKUP_PERIOD = std::chrono::minutes(15);
+    static constexpr int BACKUPS = 3;
+    private:
+    std::string _filename;
+    std::thread _thread;
+    std::mutex _lock;
+    std::condition_variable _cv;
+    std::function<void()> _wake;
+    bool _stopping=false;
+    bool _changed=false; // touched since the last due()
+    Clock::time_point _first_change, _last_change;
+    std::atomic<bool> _due{false};
+    bool _has_document=false;
+    nlohmann::json _document;
+    bool _backed_up=false;
+    Clock::time_point _last_backup;
+    void work();
+    void write(const nlohmann::json& document);
+    public:
+    Autosaver(std::string filename) : _filename(filename) {}
+    ~Autosaver() {
+        stop();
+    }
+    void start(std::function<void()> wake);
+    // drops anything not written yet and joins, the caller saves the final state itself
+    void stop();
+    void touch();
+    // true once per debounced run of changes
+    bool due() {
+        return _due.exchange(false);
+    }
+    // queues the document for writing, replacing one still waiting
+    void save(nlohmann::json document);
+};
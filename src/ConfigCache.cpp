@@ -0,0 +1,276 @@
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#include "AtomicFile.hpp"
+#include "ConfigCache.hpp"
+
+namespace ConfigCache {
+    static const char MAGIC[4] = {'S', 'B', 'C', 'C'};
+    static const uint32_t VERSION = 1;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t text_size;
+        int64_t text_mtime;
+    };
+
+    enum Kind : uint8_t { Number, Integer, Bool, String };
+    // the keys ConfiguredMusic::Save() writes, sorted so entries are built by appending
+    struct Field {
+        const char* key;
+        Kind kind;
+    };
+    static const Field FIELDS[] = {
+        {"a", Bool}, {"da", Integer}, {"et", Number}, {"p", Number}, {"pc", Integer},
+        {"r", Bool}, {"s", Number}, {"st", Number}, {"tg", String}, {"v", Number},
+    };
+    static const size_t FIELD_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+
+    static bool Stamp(const std::string& json_filename, Header& header) {
+        std::error_code ec;
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.text_size = std::filesystem::file_size(json_filename, ec);
+        if (ec) {
+            return false;
+        }
+        header.text_mtime = std::filesystem::last_write_time(json_filename, ec).time_since_epoch().count();
+        return !ec;
+    }
+
+    static const Field* FindField(const std::string& key) {
+        for (const Field& f : FIELDS) {
+            if (key == f.key) {
+                return &f;
+            }
+        }
+        return nullptr;
+    }
+
+    static bool Fits(const nlohmann::json& entry) {
+        if (!entry.is_object()) {
+            return false;
+        }
+        for (auto& [key, value] : entry.items()) {
+            const Field* f = FindField(key);
+            if (f == nullptr) {
+                return false;
+            }
+            switch (f->kind) {
+                case Number: if (!value.is_number()) return false; break;
+                case Integer: if (!value.is_number_integer()) return false; break;
+                case Bool: if (!value.is_boolean()) return false; break;
+                case String: if (!value.is_string()) return false; break;
+            }
+        }
+        return true;
+    }
+
+    template<class T>
+    static void Put(std::string& out, T value) {
+        out.append((const char*)&value, sizeof(value));
+    }
+
+    static void PutString(std::string& out, const std::string& s) {
+        Put<uint32_t>(out, s.size());
+        out.append(s);
+    }
+
+    struct Reader {
+        const char* at;
+        const char* end;
+        template<class T>
+        bool get(T& value) {
+            if ((size_t)(end - at) < sizeof(value)) {
+                return false;
+            }
+            memcpy(&value, at, sizeof(value));
+            at += sizeof(value);
+            return true;
+        }
+        bool getString(std::string& s) {
+            uint32_t size;
+            if (!get(size) || (size_t)(end - at) < size) {
+                return false;
+            }
+            s.assign(at, size);
+            at += size;
+            return true;
+        }
+    };
+
+    std::string Filename(const std::string& json_filename) {
+        return std::filesystem::path(json_filename).replace_extension(".bin").string();
+    }
+
+    bool Write(const std::string& json_filename, const nlohmann::json& data) {
+        Header header;
+        if (!data.is_object() || !Stamp(json_filename, header)) {
+            return false;
+        }
+        std::string out((const char*)&header, sizeof(header));
+        auto sounds = data.find("loaded_sounds");
+        auto configs = data.find("sound_configs");
+        bool flat_sounds = sounds != data.end() && sounds->is_array();
+        for (size_t i = 0; flat_sounds && i < sounds->size(); i++) {
+            flat_sounds = (*sounds)[i].is_string();
+        }
+        bool flat_configs = configs != data.end() && configs->is_object();
+
+        // what the tables can't hold, built from references so the big arrays aren't copied
+        nlohmann::json rest = nlohmann::json::object();
+        for (auto it = data.begin(); it != data.end(); ++it) {
+            if (!(flat_sounds && it == sounds) && !(flat_configs && it == configs)) {
+                rest[it.key()] = it.value();
+            }
+        }
+        std::vector<const std::pair<const std::string, nlohmann::json>*> entries;
+        if (flat_configs) {
+            nlohmann::json& left = rest["sound_configs"] = nlohmann::json::object();
+            for (auto& item : configs->get_ref<const nlohmann::json::object_t&>()) {
+                if (Fits(item.second)) {
+                    entries.push_back(&item);
+                } else {
+                    left[item.first] = item.second;
+                }
+            }
+        }
+        std::string cbor;
+        nlohmann::json::to_cbor(rest, cbor);
+        Put<uint8_t>(out, (flat_sounds ? 1 : 0) | (flat_configs ? 2 : 0));
+        PutString(out, cbor);
+        if (flat_sounds) {
+            Put<uint32_t>(out, sounds->size());
+            for (auto& s : *sounds) {
+                PutString(out, s.get_ref<const std::string&>());
+            }
+        }
+        Put<uint32_t>(out, entries.size());
+        for (auto* item : entries) {
+            PutString(out, item->first);
+            uint16_t present = 0, is_unsigned = 0;
+            for (size_t f = 0; f < FIELD_COUNT; f++) {
+                auto v = item->second.find(FIELDS[f].key);
+                if (v != item->second.end()) {
+                    present |= 1 << f;
+                    is_unsigned |= v->is_number_unsigned() ? 1 << f : 0;
+                }
+            }
+            Put(out, present);
+            Put(out, is_unsigned);
+            for (size_t f = 0; f < FIELD_COUNT; f++) {
+                if (!(present & (1 << f))) {
+                    continue;
+                }
+                const nlohmann::json& v = item->second[FIELDS[f].key];
+                switch (FIELDS[f].kind) {
+                    case Number: Put<double>(out, v.get<double>()); break;
+                    case Integer: Put<int64_t>(out, v.is_number_unsigned() ? (int64_t)v.get<uint64_t>() : v.get<int64_t>()); break;
+                    case Bool: Put<uint8_t>(out, v.get<bool>()); break;
+                    case String: PutString(out, v.get_ref<const std::string&>()); break;
+                }
+            }
+        }
+        return WriteFileAtomic(Filename(json_filename), out);
+    }
+
+    bool Read(const std::string& json_filename, nlohmann::json& data) {
+        Header expected, header;
+        if (!Stamp(json_filename, expected)) {
+            return false;
+        }
+        std::ifstream fd(Filename(json_filename), std::ios::binary | std::ios::ate);
+        if (!fd.is_open()) {
+            return false;
+        }
+        std::string bytes(fd.tellg(), '\0');
+        fd.seekg(0);
+        if (!fd.read(bytes.data(), bytes.size())) {
+            return false;
+        }
+        Reader in{bytes.data(), bytes.data() + bytes.size()};
+        if (!in.get(header) || memcmp(&header, &expected, sizeof(header)) != 0) {
+            return false;
+        }
+        uint8_t flags;
+        std::string cbor;
+        if (!in.get(flags) || !in.getString(cbor)) {
+            return false;
+        }
+        nlohmann::json result;
+        try {
+            result = nlohmann::json::from_cbor(cbor);
+        } catch (nlohmann::detail::exception&) {
+            return false;
+        }
+        if (!result.is_object()) {
+            return false;
+        }
+        if (flags & 1) {
+            uint32_t count;
+            if (!in.get(count)) {
+                return false;
+            }
+            nlohmann::json::array_t sounds;
+            sounds.reserve(count);
+            std::string s;
+            for (uint32_t i = 0; i < count; i++) {
+                if (!in.getString(s)) {
+                    return false;
+                }
+                sounds.emplace_back(std::move(s));
+            }
+            result["loaded_sounds"] = std::move(sounds);
+        }
+        uint32_t count;
+        if (!in.get(count)) {
+            return false;
+        }
+        if (flags & 2) {
+            nlohmann::json& configs = result["sound_configs"];
+            if (!configs.is_object()) {
+                configs = nlohmann::json::object();
+            }
+            auto& table = configs.get_ref<nlohmann::json::object_t&>();
+            std::string path, s;
+            for (uint32_t i = 0; i < count; i++) {
+                uint16_t present, is_unsigned;
+                if (!in.getString(path) || !in.get(present) || !in.get(is_unsigned)) {
+                    return false;
+                }
+                nlohmann::json entry(nlohmann::json::value_t::object);
+                auto& fields = entry.get_ref<nlohmann::json::object_t&>();
+                for (size_t f = 0; f < FIELD_COUNT; f++) {
+                    if (!(present & (1 << f))) {
+                        continue;
+                    }
+                    nlohmann::json v;
+                    double d;
+                    int64_t n;
+                    uint8_t b;
+                    switch (FIELDS[f].kind) {
+                        case Number: if (!in.get(d)) return false; v = d; break;
+                        case Integer:
+                            if (!in.get(n)) return false;
+                            v = is_unsigned & (1 << f) ? nlohmann::json((uint64_t)n) : nlohmann::json(n);
+                            break;
+                        case Bool: if (!in.get(b)) return false; v = b != 0; break;
+                        case String: if (!in.getString(s)) return false; v = std::move(s); break;
+                    }
+                    fields.emplace_hint(fields.end(), FIELDS[f].key, std::move(v));
+                }
+                // entries were written in order, appending keeps the insert constant time
+                table.emplace_hint(table.end(), std::move(path), std::move(entry));
+            }
+        }
+        if (in.at != in.end) {
+            return false;
+        }
+        data = std::move(result);
+        return true;
+    }
+}
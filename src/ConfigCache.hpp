@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+
+#include "../include/nlohmann/json.hpp"
+
+// binary copy of config.json written next to it on every save, read instead of the json while the json
+// is still the one it was written with (same size and modification time), so editing config.json by hand
+// or restoring a backup simply outdates it.
+// nlohmann's binary readers build the same tree node by node and are no faster than its text parser, so
+// "loaded_sounds" and the entries of "sound_configs" are stored as flat tables that are read straight into
+// the tree. everything else, and entries with keys or types the tables don't know, goes in as CBOR.
+namespace ConfigCache {
+    std::string Filename(const std::string& json_filename);
+    // false when the copy is missing, outdated or damaged
+    bool Read(const std::string& json_filename, nlohmann::json& data);
+    // call right after writing json_filename
+    bool Write(const std::string& json_filename, const nlohmann::json& data);
+}
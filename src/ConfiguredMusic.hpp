@@ -1,40 +1,218 @@
 #pragma once
+#include <atomic>
+#include <chrono>
 #include <filesystem>
 
 #include "../thirdparty/raylib-5.0/src/raylib.h"
 #include "../thirdparty/imgui-docking/imgui/imgui.h"
-#include "../include/nlohmann/json.hpp"
 #include "FileDialogs.hpp"
+#include "MetadataCache.hpp"
+#include "SoundBundle.hpp"
+#include "SoundSettings.hpp"
 
 class ConfiguredMusic {
     public:
-    Music music;
+    Music music={0};
+    SoundMetadata metadata;
     float volume=1.0f, pan=0.5f;
     float time=0.0f, length=0.0f, pitch=1.0f;
     float start_time=0.0f, end_time=0.0f;
     std::filesystem::path path;
     std::string name;
-    bool started=false, repeating=false, show_advanced=false;
+    std::string tags; // free text matched by the search box
+    std::wstring sort_key; // FileDialogs::CollationKey of the path
+    int64_t date_added=0; // seconds since the epoch
+    unsigned int play_count=0;
+    bool loaded=false, started=false, repeating=false, show_advanced=false;
+    bool tags_changed=false; // set by Show() when the tags were edited
+    bool preload=false; // bound and warmed clips keep their samples decoded in memory
+    bool load_failed=false; // not retried until the file changes or the user asks
+    bool opening=false; // the sound loader is opening the decoder
+    bool start_requested=false; // set by Show() when an unopened sound is played, the engine opens and starts it
+    size_t preloaded_bytes=0;
     ConfiguredMusic() {}
     ConfiguredMusic(Music s, std::filesystem::path p)
         : music(s), path(p) {
-            length = GetMusicTimeLength(music);
-            name = std::string(path.filename().string());
+            loaded = true;
+            metadata = MetadataOf(music);
+            length = metadata.length;
+            name = NameOf(path);
+            sort_key = FileDialogs::CollationKey(path.wstring());
+            date_added = Now();
             end_time = length;
         }
-    static ConfiguredMusic* Load(std::filesystem::path p, nlohmann::json cfg) {
-        Music m = LoadMusicStream(FileDialogs::NarrowString16To8(p.wstring()).c_str());
+    // entry whose decoder is opened later through the sound loader, metadata may be unknown (invalid)
+    ConfiguredMusic(std::filesystem::path p, SoundMetadata md)
+        : metadata(md), path(p) {
+            length = metadata.length;
+            name = NameOf(path);
+            sort_key = FileDialogs::CollationKey(path.wstring());
+            date_added = Now();
+            end_time = length;
+        }
+    static int64_t Now() {
+        return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+    // clips up to this length (in seconds) that are asked to preload are decoded and resampled to the device format
+    // at load time, as long as all of them together stay under the budget. the rest stream like long sounds
+    static constexpr float PRELOAD_MAX_LENGTH = 10.0f;
+    static constexpr size_t PRELOAD_BUDGET = 256u << 20;
+    static inline std::atomic<size_t> preloaded_total{0};
+    // takes bytes from the budget, false if they don't fit. clips are preloaded on several threads at once,
+    // so the check and the add are one step
+    static bool ReservePreloaded(size_t bytes) {
+        size_t total = preloaded_total.load();
+        do {
+            if (total + bytes > PRELOAD_BUDGET) {
+                return false;
+            }
+        } while (!preloaded_total.compare_exchange_weak(total, total + bytes));
+        return true;
+    }
+    static void ReleasePreloaded(size_t bytes) {
+        preloaded_total -= bytes;
+    }
+    // float stereo at a typical device rate, corrected once the clip is decoded
+    static size_t PreloadEstimate(float length) {
+        return ((size_t)(length * 48000.0f) + 1) * 2 * sizeof(float);
+    }
+    // the clip decoded to the device format, not ready if it can't be decoded or doesn't fit in the budget.
+    // preloaded is set to the bytes taken from it
+    static Music OpenPreloaded(const std::string& fname, float length, size_t& preloaded) {
+        Music none = {0};
+        preloaded = 0;
+        size_t estimate = PreloadEstimate(length);
+        if (!ReservePreloaded(estimate)) {
+            return none;
+        }
+        Music pm = OpenStream(fname, true);
+        if (!IsMusicReady(pm)) {
+            ReleasePreloaded(estimate);
+            return none;
+        }
+        size_t bytes = (size_t)pm.frameCount * pm.stream.channels * (pm.stream.sampleSize / 8);
+        if (bytes > estimate && !ReservePreloaded(bytes - estimate)) {
+            UnloadMusicStream(pm);
+            ReleasePreloaded(estimate);
+            return none;
+        }
+        if (bytes < estimate) {
+            ReleasePreloaded(estimate - bytes);
+        }
+        preloaded = bytes;
+        return pm;
+    }
+    static std::string NameOf(const std::filesystem::path& p) {
+        std::string bundle, name;
+        if (SoundBundle::SplitMemberPath(p.string(), bundle, name)) {
+            return name;
+        }
+        return p.filename().string();
+    }
+    // sounds in a bundle are decoded from its mapping, anything else from its file
+    static Music OpenStream(const std::string& fname, bool preloaded) {
+        SoundBundle* bundle;
+        const SoundBundle::Entry* entry;
+        if (SoundBundle::Locate(fname, bundle, entry)) {
+            if (preloaded) {
+                return LoadMusicStreamPreloadedFromMemory(entry->format.c_str(), bundle->data(*entry), (int)entry->length);
+            }
+            return LoadMusicStreamFromMemory(entry->format.c_str(), bundle->data(*entry), (int)entry->length);
+        }
+        return preloaded ? LoadMusicStreamPreloaded(fname.c_str()) : LoadMusicStream(fname.c_str());
+    }
+    // md is the cached metadata, when it knows the length the file is only opened once.
+    // preloaded is set to the bytes taken from the budget
+    static bool Open(std::filesystem::path p, Music& out, bool preload, const SoundMetadata& md, size_t& preloaded) {
+        std::string fname = FileDialogs::NarrowString16To8(p.wstring());
+        preloaded = 0;
+        // module formats are generated on the fly and can't be decoded to a wave
+        preload = preload && !IsFileExtension(fname.c_str(), ".xm;.mod");
+        if (preload && md.valid()) {
+            if (md.length <= PRELOAD_MAX_LENGTH) {
+                Music pm = OpenPreloaded(fname, md.length, preloaded);
+                if (IsMusicReady(pm)) {
+                    out = pm;
+                    return true;
+                }
+            }
+            preload = false;
+        }
+        Music m = OpenStream(fname, false);
         if (!IsMusicReady(m)) {
+            return false;
+        }
+        if (preload && GetMusicTimeLength(m) <= PRELOAD_MAX_LENGTH) {
+            Music pm = OpenPreloaded(fname, GetMusicTimeLength(m), preloaded);
+            if (IsMusicReady(pm)) {
+                UnloadMusicStream(m);
+                m = pm;
+            }
+        }
+        out = m;
+        return true;
+    }
+    // opens and closes the decoder only to read the stream properties, safe to call from a worker thread
+    static bool Probe(std::filesystem::path p, SoundMetadata& out) {
+        std::string fname = FileDialogs::NarrowString16To8(p.wstring());
+        Music m = OpenStream(fname, false);
+        if (!IsMusicReady(m)) {
+            return false;
+        }
+        out = MetadataOf(m);
+        UnloadMusicStream(m);
+        return true;
+    }
+    static SoundMetadata MetadataOf(Music m) {
+        SoundMetadata md;
+        md.length = GetMusicTimeLength(m);
+        md.channels = m.stream.channels;
+        md.sample_rate = m.stream.sampleRate;
+        md.sample_size = m.stream.sampleSize;
+        return md;
+    }
+    static ConfiguredMusic* Load(std::filesystem::path p, const SoundSettings& settings, bool preload=false, SoundMetadata md=SoundMetadata()) {
+        Music m;
+        size_t preloaded;
+        if (!Open(p, m, preload, md, preloaded)) {
             return nullptr;
         }
         ConfiguredMusic* cs = new ConfiguredMusic(m, p);
-        cs->Load(cfg);
+        cs->preload = preload;
+        cs->preloaded_bytes = preloaded;
+        cs->Load(settings);
         cs->Update();
         return cs;
     }
+    // creates the entry without touching the file, the decoder is opened on first use
+    static ConfiguredMusic* LoadLazy(std::filesystem::path p, const SoundSettings& settings, SoundMetadata md) {
+        ConfiguredMusic* cs = new ConfiguredMusic(p, md);
+        cs->Load(settings);
+        return cs;
+    }
+    // takes the stream opened for this entry off the UI thread, preloaded is what it took from the budget
+    void Adopt(Music m, size_t preloaded) {
+        music = m;
+        preloaded_bytes = preloaded;
+        loaded = true;
+        opening = false;
+        bool length_was_known = metadata.valid();
+        metadata = MetadataOf(music);
+        length = metadata.length;
+        if (!length_was_known || end_time > length) {
+            end_time = length;
+        }
+        Update();
+    }
     void Unload() {
-        UnloadMusicStream(music);
+        if (loaded) {
+            UnloadMusicStream(music);
+        }
+        ReleasePreloaded(preloaded_bytes);
+        preloaded_bytes = 0;
         music = {0};
+        loaded = false;
+        started = false;
     }
     void Update() {
         SetMusicVolume(music, volume);
@@ -47,10 +225,20 @@ class ConfiguredMusic {
         time = 0.0f;
     }
     void Play() {
-        PlayMusicStream(music);
+        if (loaded) {
+            PlayMusicStream(music);
+        }
     }
-    void Start() {
+    // counted is for starts a user or command asked for, loop restarts and sequence advances don't count as plays.
+    // does nothing until the decoder is open
+    void Start(bool counted=false) {
+        if (!loaded) {
+            return;
+        }
         Play();
+        if (counted) {
+            play_count++;
+        }
         if (start_time >= 0.01f) {
             SeekMusicStream(music, start_time);
         }
@@ -63,11 +251,13 @@ class ConfiguredMusic {
         if (started) {
             ResumeMusicStream(music);
         } else {
-            Start();
+            Start(true);
         }
     }
     void Seek(float t) {
-        SeekMusicStream(music, t);
+        if (loaded) {
+            SeekMusicStream(music, t);
+        }
     }
     bool ShouldEnd(float dt) {
         return Tell()+dt*0.95f >= end_time;
@@ -87,16 +277,18 @@ class ConfiguredMusic {
         pitch = v;
         SetMusicPitch(music, pitch);
     }
-    // returns true unless the music has ended and is not set to loop.
-    bool Show(float dt) {
+    // draws the controls, the stream itself is serviced by the AudioEngine.
+    // returns true if the controls (and the progress slider) are visible.
+    bool Show() {
         time = Tell();
-        ImGui::Begin("Audio Controls");
+        bool visible = ImGui::Begin("Audio Controls");
         ImGui::Text("%s", name.c_str());
-        bool ended = false;
-        if ((ended = ShouldEnd(dt))) {
-            Stop();
-            if (repeating) {
-                Start();
+        if (load_failed) {
+            ImGui::SameLine();
+            ImGui::TextColored({1.0f, 0.4f, 0.4f, 1.0f}, "(can't be opened)");
+            ImGui::SameLine();
+            if (ImGui::Button("Retry")) {
+                load_failed = false;
             }
         }
 
@@ -113,14 +305,20 @@ class ConfiguredMusic {
         if (ImGui::Button("Play/Pause")) {
             if (IsMusicStreamPlaying(music)) {
                 Pause();
-            } else {
+            } else if (loaded) {
                 Resume();
+            } else {
+                start_requested = true;
             }
         }
         ImGui::SameLine();
         if (ImGui::Button("Restart")) {
-            Stop();
-            Start();
+            if (loaded) {
+                Stop();
+                Start();
+            } else {
+                start_requested = true;
+            }
         }
         if (ImGui::Checkbox("Loop", &repeating)) {
             ;
@@ -138,6 +336,12 @@ class ConfiguredMusic {
             if (ImGui::SliderFloat("Speed/Pitch", &pitch, 0.01f, 2.0f)) {
                 Pitch(pitch);
             }
+            char tags_buffer[256];
+            snprintf(tags_buffer, sizeof(tags_buffer), "%s", tags.c_str());
+            if (ImGui::InputText("Tags", tags_buffer, sizeof(tags_buffer))) {
+                tags = tags_buffer;
+                tags_changed = true;
+            }
             ImGui::Text("Crop");
             if (ImGui::SliderFloat("Start Time", &start_time, 0.0f, length)) {
                 if (start_time > end_time) {
@@ -152,41 +356,54 @@ class ConfiguredMusic {
             }
         }
         ImGui::End();
-        UpdateMusicStream(music);
-        return !ended;
+        return visible;
     }
-    void Load(nlohmann::json cfg) {
-        if (cfg.contains("v") && cfg["v"].is_number()) {
-            volume = cfg["v"].get<float>();
+    // applies the settings that are present, the others keep their defaults
+    void Load(const SoundSettings& settings) {
+        if (settings.has(SoundSettings::Volume)) {
+            volume = settings.volume;
+        }
+        if (settings.has(SoundSettings::Pitch)) {
+            pitch = settings.pitch;
+        }
+        if (settings.has(SoundSettings::Pan)) {
+            pan = settings.pan;
+        }
+        if (settings.has(SoundSettings::Repeating)) {
+            repeating = settings.repeating;
         }
-        if (cfg.contains("s") && cfg["s"].is_number()) {
-            pitch = cfg["s"].get<float>();
+        if (settings.has(SoundSettings::ShowAdvanced)) {
+            show_advanced = settings.show_advanced;
         }
-        if (cfg.contains("p") && cfg["p"].is_number()) {
-            pan = cfg["p"].get<float>();
+        if (settings.has(SoundSettings::StartTime)) {
+            start_time = settings.start_time;
         }
-        if (cfg.contains("r") && cfg["r"].is_boolean()) {
-            repeating = cfg["r"].get<bool>();
+        if (settings.has(SoundSettings::EndTime)) {
+            end_time = settings.end_time;
         }
-        if (cfg.contains("a") && cfg["a"].is_boolean()) {
-            show_advanced = cfg["a"].get<bool>();
+        if (settings.has(SoundSettings::DateAdded)) {
+            date_added = settings.date_added;
         }
-        if (cfg.contains("st") && cfg["st"].is_number()) {
-            start_time = cfg["st"].get<float>();
+        if (settings.has(SoundSettings::PlayCount)) {
+            play_count = settings.play_count;
         }
-        if (cfg.contains("et") && cfg["et"].is_number()) {
-            end_time = cfg["et"].get<float>();
+        if (settings.has(SoundSettings::Tags)) {
+            tags = settings.tags;
         }
     }
-    nlohmann::json Save() {
-        return {
-            {"v", volume},
-            {"s", pitch},
-            {"p", pan},
-            {"r", repeating},
-            {"a", show_advanced},
-            {"st", start_time},
-            {"et", end_time},
-        };
+    SoundSettings Save() const {
+        SoundSettings settings;
+        settings.present = SoundSettings::All;
+        settings.volume = volume;
+        settings.pitch = pitch;
+        settings.pan = pan;
+        settings.repeating = repeating;
+        settings.show_advanced = show_advanced;
+        settings.start_time = start_time;
+        settings.end_time = end_time;
+        settings.date_added = date_added;
+        settings.play_count = play_count;
+        settings.tags = tags;
+        return settings;
     }
 };
@@ -0,0 +1,86 @@
+#include <cstdio>
+#include <cstring>
+
+#include "../thirdparty/raylib-5.0/src/raylib.h"
+#include "ConsoleLog.hpp"
+
+static const char* level_names[] = {
+    "TRACE",
+    "DEBUG",
+    "INFO",
+    "WARN",
+    "ERROR",
+    "FATAL",
+};
+
+ConsoleLog::ConsoleLog() {
+    _queue = new Slot[QUEUE_SIZE];
+    for (size_t i = 0; i < QUEUE_SIZE; i++) {
+        _queue[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    _lines.resize(MAX_LINES);
+}
+
+ConsoleLog::~ConsoleLog() {
+    delete[] _queue;
+}
+
+void ConsoleLog::push(int level, const char* fmt, va_list va) {
+    if (level < LOG_TRACE || level > LOG_FATAL) {
+        level = LOG_TRACE;
+    }
+    // claim a slot, bounded multi-producer queue with a sequence number per slot
+    size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &_queue[pos & (QUEUE_SIZE - 1)];
+        size_t seq = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = _enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+    slot->line.level = level;
+    int n = snprintf(slot->line.text, LINE_SIZE, "[%s] ", level_names[level - LOG_TRACE]);
+    vsnprintf(slot->line.text + n, LINE_SIZE - n, fmt, va);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+void ConsoleLog::print(int level, const char* fmt, ...) {
+    va_list va;
+    va_start(va, fmt);
+    push(level, fmt, va);
+    va_end(va);
+}
+
+size_t ConsoleLog::drain() {
+    size_t count = 0;
+    while (true) {
+        Slot* slot = &_queue[_dequeue_pos & (QUEUE_SIZE - 1)];
+        if (slot->sequence.load(std::memory_order_acquire) != _dequeue_pos + 1) {
+            break;
+        }
+        if (_count < MAX_LINES) {
+            _lines[(_first + _count) % MAX_LINES] = slot->line;
+            _count++;
+        } else {
+            _lines[_first] = slot->line;
+            _first = (_first + 1) % MAX_LINES;
+        }
+        printf("%s\n", slot->line.text);
+        slot->sequence.store(_dequeue_pos + QUEUE_SIZE, std::memory_order_release);
+        _dequeue_pos++;
+        count++;
+    }
+    if (count > 0) {
+        fflush(stdout);
+    }
+    return count;
+}
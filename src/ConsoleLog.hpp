@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <vector>
+
+// log lines for the Console window.
+// any thread (including the audio callback) formats straight into a slot of a fixed lock-free queue,
+// the UI thread drains the queue into a bounded ring of lines and echoes them to stdout.
+class ConsoleLog {
+    public:
+    static constexpr size_t QUEUE_SIZE = 4096; // must be a power of two
+    static constexpr size_t LINE_SIZE = 256;
+    static constexpr size_t MAX_LINES = 10000;
+    struct Line {
+        int level;
+        char text[LINE_SIZE];
+    };
+    private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        Line line;
+    };
+    Slot* _queue;
+    std::atomic<size_t> _enqueue_pos{0};
+    size_t _dequeue_pos=0;
+    std::atomic<unsigned int> _dropped{0};
+    std::vector<Line> _lines; // ring, _first is the oldest line
+    size_t _first=0, _count=0;
+    public:
+    ConsoleLog();
+    ~ConsoleLog();
+    // never blocks or allocates, the message is dropped if the queue is full
+    void push(int level, const char* fmt, va_list va);
+    void print(int level, const char* fmt, ...);
+    // UI thread only. moves queued messages into the ring, returns how many were moved
+    size_t drain();
+    // UI thread only. 0 is the oldest line still kept
+    const Line& at(size_t i) const {
+        return _lines[(_first + i) % MAX_LINES];
+    }
+    size_t size() const {
+        return _count;
+    }
+    void clear() {
+        _first = 0;
+        _count = 0;
+    }
+    // messages lost to a full queue since the last call
+    unsigned int dropped() {
+        return _dropped.exchange(0);
+    }
+};
@@ -0,0 +1,346 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "../thirdparty/raylib-5.0/src/raylib.h"
+#include "ControlSocket.hpp"
+
+ControlSocket::~ControlSocket() {
+    close();
+}
+
+#ifndef WIN32
+std::string ControlSocket::DefaultPath() {
+    const char* runtime_dir = getenv("XDG_RUNTIME_DIR");
+    if (runtime_dir != nullptr && runtime_dir[0] != 0) {
+        return std::string(runtime_dir) + "/becks-soundboard.sock";
+    }
+    return "/tmp/becks-soundboard-" + std::to_string(getuid()) + ".sock";
+}
+
+static bool Address(const std::string& path, sockaddr_un& addr) {
+    addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        TraceLog(LOG_ERROR, "Control socket path is too long: \"%s\"", path.c_str());
+        return false;
+    }
+    strcpy(addr.sun_path, path.c_str());
+    return true;
+}
+
+ControlSocket::OpenResult ControlSocket::open(const std::string& path) {
+    sockaddr_un addr;
+    if (!Address(path, addr)) {
+        return Failed;
+    }
+    // held until close(), two launches at the same time can't both take over the socket file
+    std::string lock_path = path + ".lock";
+    _lock_fd = ::open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (_lock_fd < 0) {
+        TraceLog(LOG_ERROR, "Failed to open \"%s\": %s", lock_path.c_str(), strerror(errno));
+        return Failed;
+    }
+    if (flock(_lock_fd, LOCK_EX | LOCK_NB) < 0) {
+        bool running = errno == EWOULDBLOCK;
+        if (!running) {
+            TraceLog(LOG_ERROR, "Failed to lock \"%s\": %s", lock_path.c_str(), strerror(errno));
+        }
+        ::close(_lock_fd);
+        _lock_fd = -1;
+        return running ? AlreadyRunning : Failed;
+    }
+    // a socket file left behind by a crash is replaced
+    unlink(path.c_str());
+    _listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    mode_t old_mask = umask(0077);
+    int rc = bind(_listen_fd, (sockaddr*)&addr, sizeof(addr));
+    umask(old_mask);
+    if (rc < 0 || listen(_listen_fd, 8) < 0) {
+        TraceLog(LOG_ERROR, "Failed to listen on \"%s\": %s", path.c_str(), strerror(errno));
+        close();
+        return Failed;
+    }
+    if (pipe(_wake_fds) < 0) {
+        TraceLog(LOG_ERROR, "Failed to create control socket wake pipe: %s", strerror(errno));
+        close();
+        return Failed;
+    }
+    for (int fd : _wake_fds) {
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    _path = path;
+    TraceLog(LOG_INFO, "Listening for commands on \"%s\"", path.c_str());
+    return Opened;
+}
+
+void ControlSocket::close() {
+    for (auto& c : _clients) {
+        ::close(c.second.fd);
+    }
+    _clients.clear();
+    if (_listen_fd >= 0) {
+        ::close(_listen_fd);
+        _listen_fd = -1;
+        unlink(_path.c_str());
+    }
+    // the lock file stays, removing it would race with the next instance taking it
+    if (_lock_fd >= 0) {
+        ::close(_lock_fd);
+        _lock_fd = -1;
+    }
+    for (int& fd : _wake_fds) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+}
+
+size_t ControlSocket::wait(std::vector<Command>& out, int timeout_ms) {
+    size_t count = out.size();
+    for (auto it = _clients.begin(); it != _clients.end();) {
+        if (it->second.eof && it->second.unanswered == 0) {
+            ::close(it->second.fd);
+            it = _clients.erase(it);
+        } else {
+            it++;
+        }
+    }
+    std::vector<pollfd> fds;
+    std::vector<uint64_t> polled; // the client of each fd after the first two
+    fds.push_back({_wake_fds[0], POLLIN, 0});
+    fds.push_back({_listen_fd, POLLIN, 0});
+    // a client at eof stays readable, it is only kept around for its replies
+    for (auto& c : _clients) {
+        if (!c.second.eof) {
+            fds.push_back({c.second.fd, POLLIN, 0});
+            polled.push_back(c.first);
+        }
+    }
+    if (::poll(fds.data(), fds.size(), timeout_ms) <= 0) {
+        return 0;
+    }
+    if (fds[0].revents & POLLIN) {
+        char buf[64];
+        while (::read(_wake_fds[0], buf, sizeof(buf)) > 0) {}
+    }
+    if (fds[1].revents & POLLIN) {
+        accept();
+    }
+    for (size_t i = 2; i < fds.size(); i++) {
+        if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+            if (!read(polled[i - 2], out)) {
+                drop(polled[i - 2]);
+            }
+        }
+    }
+    return out.size() - count;
+}
+
+void ControlSocket::accept() {
+    int fd;
+    while ((fd = ::accept4(_listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        _clients[_next_client++].fd = fd;
+    }
+}
+
+bool ControlSocket::read(uint64_t client, std::vector<Command>& out) {
+    Client& c = _clients[client];
+    std::string& pending = c.pending;
+    char buf[1024];
+    while (true) {
+        ssize_t n = ::read(c.fd, buf, sizeof(buf));
+        if (n == 0) {
+            // the client may have only shut down its writing side and still wait for the replies
+            c.eof = true;
+            return true;
+        }
+        if (n < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            if (buf[i] == '\n') {
+                if (pending.size() > 0 && pending.back() == '\r') {
+                    pending.pop_back();
+                }
+                out.push_back({client, std::move(pending)});
+                pending.clear();
+                c.unanswered++;
+            } else if (pending.size() < MAX_LINE) {
+                pending.push_back(buf[i]);
+            } else {
+                TraceLog(LOG_WARNING, "Control client sent a line longer than %d bytes, disconnecting it.", (int)MAX_LINE);
+                return false;
+            }
+        }
+    }
+}
+
+void ControlSocket::drop(uint64_t client) {
+    auto it = _clients.find(client);
+    if (it != _clients.end()) {
+        ::close(it->second.fd);
+        _clients.erase(it);
+    }
+}
+
+void ControlSocket::reply(uint64_t client, const std::string& text) {
+    auto it = _clients.find(client);
+    if (it == _clients.end()) {
+        return;
+    }
+    int fd = it->second.fd;
+    if (it->second.unanswered > 0) {
+        it->second.unanswered--;
+    }
+    // replies are short, a client that doesn't read them is dropped rather than blocking the daemon
+    size_t sent = 0;
+    while (sent < text.size()) {
+        ssize_t n = send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            drop(client);
+            return;
+        }
+        sent += n;
+    }
+}
+
+void ControlSocket::wake() {
+    if (_wake_fds[1] >= 0) {
+        char c = 0;
+        (void)!::write(_wake_fds[1], &c, 1);
+    }
+}
+
+bool ControlSocket::Send(const std::string& path, const std::vector<std::string>& lines, std::string& replies) {
+    sockaddr_un addr;
+    if (!Address(path, addr)) {
+        return false;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+    std::string text;
+    for (auto& line : lines) {
+        text += line + "\n";
+    }
+    for (size_t sent = 0; sent < text.size();) {
+        ssize_t n = send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0 && errno != EINTR) {
+            ::close(fd);
+            return false;
+        }
+        sent += std::max<ssize_t>(n, 0);
+    }
+    // the instance closes the connection once every command is answered
+    shutdown(fd, SHUT_WR);
+    pollfd p = {fd, POLLIN, 0};
+    char buf[1024];
+    while (::poll(&p, 1, 5000) > 0) {
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n <= 0) {
+            break;
+        }
+        replies.append(buf, n);
+    }
+    ::close(fd);
+    return true;
+}
+#else
+std::string ControlSocket::DefaultPath() {
+    return "";
+}
+
+ControlSocket::OpenResult ControlSocket::open(const std::string& path) {
+    TraceLog(LOG_ERROR, "The control socket isn't supported on this platform.");
+    return Failed;
+}
+
+void ControlSocket::close() {}
+
+size_t ControlSocket::wait(std::vector<Command>& out, int timeout_ms) {
+    return 0;
+}
+
+void ControlSocket::reply(uint64_t client, const std::string& text) {}
+
+void ControlSocket::wake() {}
+
+bool ControlSocket::Send(const std::string& path, const std::vector<std::string>& lines, std::string& replies) {
+    return false;
+}
+#endif
+
+void ControlThread::start(std::function<void()> wake) {
+    _wake = wake;
+    _stopping = false;
+    _thread = std::thread(&ControlThread::work, this);
+}
+
+void ControlThread::stop() {
+    if (!_thread.joinable()) {
+        return;
+    }
+    _stopping = true;
+    _socket.wake();
+    _thread.join();
+}
+
+void ControlThread::work() {
+    std::vector<ControlSocket::Command> commands;
+    std::vector<std::pair<uint64_t, std::string>> replies;
+    while (!_stopping) {
+        commands.clear();
+        _socket.wait(commands, -1);
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            for (auto& c : commands) {
+                _commands.push_back(std::move(c));
+            }
+            replies.swap(_replies);
+        }
+        for (auto& r : replies) {
+            _socket.reply(r.first, r.second);
+        }
+        replies.clear();
+        if (commands.size() > 0) {
+            _wake();
+        }
+    }
+}
+
+void ControlThread::take(std::vector<ControlSocket::Command>& out) {
+    std::lock_guard<std::mutex> guard(_lock);
+    for (auto& c : _commands) {
+        out.push_back(std::move(c));
+    }
+    _commands.clear();
+}
+
+void ControlThread::reply(uint64_t client, const std::string& text) {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _replies.push_back({client, text});
+    }
+    _socket.wake();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// line based command socket, one command per line, replies are written back to the same client.
+// a local Unix domain socket, only the user running the soundboard can connect to it.
+// it doubles as the single instance check: whoever holds the lock file next to it owns the socket,
+// later launches hand their command line to that instance with Send().
+class ControlSocket {
+    public:
+    struct Command {
+        uint64_t client; // 0 for commands that came from no client
+        std::string line;
+    };
+    enum OpenResult {
+        Opened,
+        AlreadyRunning,
+        Failed,
+    };
+    static constexpr size_t MAX_LINE = 4096;
+    private:
+    std::string _path;
+    int _listen_fd=-1, _lock_fd=-1;
+    int _wake_fds[2] = {-1, -1};
+    // clients are known by an id that is never reused, a reply for one that left can't reach a later connection
+    // that was given the same fd
+    struct Client {
+        int fd;
+        std::string pending; // unfinished line
+        unsigned int unanswered=0; // commands still waiting for reply()
+        bool eof=false; // closed once the replies to its last commands are sent
+    };
+    std::map<uint64_t, Client> _clients;
+    uint64_t _next_client=1;
+    void accept();
+    bool read(uint64_t client, std::vector<Command>& out);
+    void drop(uint64_t client);
+    public:
+    ~ControlSocket();
+    // $XDG_RUNTIME_DIR/becks-soundboard.sock, or one in /tmp named after the user id
+    static std::string DefaultPath();
+    OpenResult open(const std::string& path);
+    void close();
+    // sleeps until commands arrive, wake() is called or timeout_ms passes (-1 waits forever)
+    size_t wait(std::vector<Command>& out, int timeout_ms);
+    void reply(uint64_t client, const std::string& text);
+    // async signal safe, interrupts wait()
+    void wake();
+    // runs the commands on the instance listening at path and appends its replies, false if none is listening
+    static bool Send(const std::string& path, const std::vector<std::string>& lines, std::string& replies);
+};
+
+// serves an opened ControlSocket from its own thread, for the windowed board which sleeps in the window's event wait.
+// commands are queued for the UI thread and wake() is called, replies are handed back to the thread to send.
+class ControlThread {
+    ControlSocket& _socket;
+    std::thread _thread;
+    std::mutex _lock;
+    std::vector<ControlSocket::Command> _commands;
+    std::vector<std::pair<uint64_t, std::string>> _replies;
+    std::atomic<bool> _stopping{false};
+    std::function<void()> _wake;
+    void work();
+    public:
+    ControlThread(ControlSocket& socket) : _socket(socket) {}
+    ~ControlThread() {
+        stop();
+    }
+    void start(std::function<void()> wake);
+    void stop();
+    // moves the queued commands into out
+    void take(std::vector<ControlSocket::Command>& out);
+    void reply(uint64_t client, const std::string& text);
+};
@@ -1,8 +1,13 @@
 #include <algorithm>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <filesystem>
 #include <locale>
+#include <map>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #include "../thirdparty/imgui-docking/imgui/imgui.h"
 #include "FileDialogs.hpp"
@@ -14,6 +19,9 @@
 #include <winbase.h>
 #endif
 
+// raylib.h clashes with the windows headers above, only this is needed from it
+extern "C" void WakeEventWaiting(void);
+
 namespace FileDialogs {
 std::vector<std::filesystem::path> pinned_folders;
 
@@ -36,6 +44,31 @@ std::wstring ExpandString8To16(std::string s) {
     return w;
 }
 
+std::wstring CollationKey(const std::wstring& s) {
+    auto& f = std::use_facet<std::ctype<wchar_t>>(std::locale());
+    std::wstring key;
+    key.reserve(s.size() + 8);
+    for (size_t i = 0; i < s.size();) {
+        if (s[i] >= L'0' && s[i] <= L'9') {
+            // leading zeros don't count, then a longer number is always a bigger one
+            while (i + 1 < s.size() && s[i] == L'0' && s[i + 1] >= L'0' && s[i + 1] <= L'9') {
+                i++;
+            }
+            size_t start = i;
+            while (i < s.size() && s[i] >= L'0' && s[i] <= L'9') {
+                i++;
+            }
+            key.push_back(L'\x01');
+            key.push_back((wchar_t)(i - start + 1));
+            key.append(s, start, i - start);
+        } else {
+            key.push_back(f.tolower(s[i]));
+            i++;
+        }
+    }
+    return key;
+}
+
 bool CanNarrowString16To8(std::wstring w) {
     for (wchar_t c : w) {
         if (c >= 256) {
@@ -68,16 +101,159 @@ std::vector<std::filesystem::path> DirList(std::filesystem::path path, bool fold
             }
         }
     }
-    auto& f = std::use_facet<std::ctype<wchar_t>>(std::locale());
-    std::sort(found.begin(), found.end(), [&f](std::filesystem::path& a, std::filesystem::path& b) -> bool {
-        std::wstring as = a.wstring();
-        std::wstring bs = b.wstring();
-        return std::lexicographical_compare(
-            as.begin(), as.end(), bs.begin(), bs.end(), [&f](wchar_t ai, wchar_t bi) {
-                return f.tolower(ai) < f.tolower(bi);
-        });
-    });
-    return found;
+    // collation keys are computed once up front instead of converting both sides on every comparison
+    std::vector<std::pair<std::wstring, size_t>> keys;
+    keys.reserve(found.size());
+    for (size_t i = 0; i < found.size(); i++) {
+        keys.emplace_back(CollationKey(found[i].wstring()), i);
+    }
+    std::sort(keys.begin(), keys.end());
+    std::vector<std::filesystem::path> sorted;
+    sorted.reserve(found.size());
+    for (auto& k : keys) {
+        sorted.push_back(std::move(found[k.second]));
+    }
+    return sorted;
+}
+
+static DirEntry MakeDirEntry(std::filesystem::path p) {
+    DirEntry entry;
+    std::wstring name = p.filename().wstring();
+    entry.can_be_loaded = CanNarrowString16To8(name);
+    entry.name = NarrowString16To8(name);
+    entry.lower = entry.name;
+    for (char& c : entry.lower) {
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+    }
+    entry.path = std::move(p);
+    return entry;
+}
+
+// one worker is enough, listing is bound by the disk or the network mount
+class DirListCache {
+    static constexpr size_t MAX_ENTRIES = 64;
+    struct Entry {
+        std::shared_ptr<const DirListing> listing;
+        std::filesystem::file_time_type mtime;
+        bool pending=false;
+        uint64_t used=0;
+    };
+    std::map<std::filesystem::path, Entry> _entries;
+    std::deque<std::filesystem::path> _queue;
+    std::mutex _lock;
+    std::condition_variable _cv;
+    std::thread _thread;
+    bool _stopping=false;
+    uint64_t _clock=0;
+
+    void work() {
+        std::unique_lock<std::mutex> guard(_lock);
+        while (true) {
+            _cv.wait(guard, [this] { return _stopping || !_queue.empty(); });
+            if (_stopping) {
+                return;
+            }
+            std::filesystem::path path = std::move(_queue.front());
+            _queue.pop_front();
+            Entry& known = _entries[path];
+            bool have = known.listing != nullptr;
+            auto known_mtime = known.mtime;
+            guard.unlock();
+
+            std::error_code ec;
+            auto mtime = std::filesystem::last_write_time(path, ec);
+            std::shared_ptr<DirListing> listing;
+            if (ec || !have || mtime != known_mtime) {
+                listing = std::make_shared<DirListing>();
+                try {
+                    for (auto& p : DirList(path, true)) {
+                        listing->folders.push_back(MakeDirEntry(std::move(p)));
+                    }
+                    for (auto& p : DirList(path, false)) {
+                        listing->files.push_back(MakeDirEntry(std::move(p)));
+                    }
+                } catch (std::filesystem::filesystem_error& e) {
+                    listing->error = e.what();
+                }
+            }
+
+            guard.lock();
+            // the entry may have been evicted in the meantime, then it's simply added again
+            Entry& entry = _entries[path];
+            entry.pending = false;
+            if (listing != nullptr) {
+                entry.listing = std::move(listing);
+                entry.mtime = mtime;
+                evict();
+                WakeEventWaiting();
+            }
+        }
+    }
+    void evict() {
+        while (_entries.size() > MAX_ENTRIES) {
+            auto oldest = _entries.end();
+            for (auto it = _entries.begin(); it != _entries.end(); it++) {
+                if (!it->second.pending && (oldest == _entries.end() || it->second.used < oldest->second.used)) {
+                    oldest = it;
+                }
+            }
+            if (oldest == _entries.end()) {
+                return;
+            }
+            _entries.erase(oldest);
+        }
+    }
+    public:
+    ~DirListCache() {
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            _stopping = true;
+        }
+        _cv.notify_all();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+    void request(const std::filesystem::path& path) {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (!_thread.joinable()) {
+            _thread = std::thread(&DirListCache::work, this);
+        }
+        Entry& entry = _entries[path];
+        entry.used = ++_clock;
+        if (!entry.pending) {
+            entry.pending = true;
+            _queue.push_back(path);
+            _cv.notify_one();
+        }
+    }
+    std::shared_ptr<const DirListing> get(const std::filesystem::path& path, bool* pending) {
+        std::lock_guard<std::mutex> guard(_lock);
+        auto it = _entries.find(path);
+        if (it == _entries.end()) {
+            if (pending != nullptr) {
+                *pending = false;
+            }
+            return nullptr;
+        }
+        it->second.used = ++_clock;
+        if (pending != nullptr) {
+            *pending = it->second.pending;
+        }
+        return it->second.listing;
+    }
+};
+
+static DirListCache dir_list_cache;
+
+void RequestDirListing(const std::filesystem::path& path) {
+    dir_list_cache.request(path);
+}
+
+std::shared_ptr<const DirListing> GetDirListing(const std::filesystem::path& path, bool* pending) {
+    return dir_list_cache.get(path, pending);
 }
 
 void AddPinnedFolder(std::filesystem::path p) {
@@ -97,11 +273,39 @@ bool FileDialog::Show(std::filesystem::path& selected) {
     bool clicked = false;
     if (needs_dirlist) {
         needs_dirlist = false;
-        listed_folders.clear();
-        listed_files.clear();
-        listed_folders = DirList(path, true);
-        listed_files = DirList(path, false);
+        if (path != listed_path) {
+            listed_path = path;
+            filter[0] = 0;
+        }
+        // the cached listing is shown right away while the worker checks whether it's still current
+        RequestDirListing(path);
+    }
+    listing = GetDirListing(listed_path, &listing_pending);
+    if (listing.get() != filtered_listing || applied_filter != filter) {
+        filtered_listing = listing.get();
+        applied_filter = filter;
+        std::string needle = applied_filter;
+        for (char& c : needle) {
+            if (c >= 'A' && c <= 'Z') {
+                c += 'a' - 'A';
+            }
+        }
+        shown_folders.clear();
+        shown_files.clear();
+        if (listing != nullptr) {
+            for (int i = 0; i < (int)listing->folders.size(); i++) {
+                if (listing->folders[i].lower.find(needle) != std::string::npos) {
+                    shown_folders.push_back(i);
+                }
+            }
+            for (int i = 0; i < (int)listing->files.size(); i++) {
+                if (listing->files[i].lower.find(needle) != std::string::npos) {
+                    shown_files.push_back(i);
+                }
+            }
+        }
     }
+    size_t listed_count = listing != nullptr ? listing->folders.size() + listing->files.size() : 0;
     bool is_open = true;
     ImGui::Begin(title.c_str(), &is_open);
     
@@ -123,8 +327,8 @@ bool FileDialog::Show(std::filesystem::path& selected) {
         int to_remove = -1;
         ImGui::PushID("Pinned");
         ImGui::Text("Pinned");
-        for (int i = 0; i < pinned_folders.size(); i++) {
-            ImGui::PushID(i+1+listed_folders.size()+listed_files.size());
+        for (int i = 0; i < (int)pinned_folders.size(); i++) {
+            ImGui::PushID(i+1+listed_count);
             std::string str = NarrowString16To8(pinned_folders[i].wstring());
             if (ImGui::Button("Unpin")) {
                 to_remove = i;
@@ -151,42 +355,59 @@ bool FileDialog::Show(std::filesystem::path& selected) {
         needs_dirlist = true;
     }
 
+    ImGui::InputTextWithHint("Filter", "type to filter", filter, sizeof(filter));
+    if (listing == nullptr) {
+        ImGui::Text("Loading...");
+    } else if (listing_pending) {
+        ImGui::SameLine();
+        ImGui::Text("Refreshing...");
+    }
+    if (listing != nullptr && !listing->error.empty()) {
+        ImGui::TextColored({1.0f, 0.0f, 0.0f, 1.0f}, "%s", listing->error.c_str());
+    }
+
     ImGui::Text("Folders");
 
-    for (int i = 0; i < listed_folders.size(); i++) {
-        auto& folderName = listed_folders[i];
-        bool can_be_loaded = CanNarrowString16To8(folderName.filename().wstring());
-        std::string str = NarrowString16To8(folderName.filename().wstring());
-        ImGui::PushID(i+1);
-        if (!can_be_loaded) {
-            ImGui::PushStyleColor(ImGuiCol_Text, {255, 0, 0, 255});
-            ImGui::PushStyleColor(ImGuiCol_Button, {60, 60, 60, 255});
-            ImGui::PushStyleColor(ImGuiCol_ButtonActive, {60, 60, 60, 255});
-            ImGui::PushStyleColor(ImGuiCol_ButtonHovered, {60, 60, 60, 255});
-        }
-        if (ImGui::Button("Pin") && can_be_loaded) {
-            AddPinnedFolder(folderName);
-        }
-        ImGui::SameLine();
-        if (ImGui::Button("Open") && can_be_loaded) {
-            path = folderName;
-            needs_dirlist = true;
-        }
-        if (folder) {
+    // rows are all one line high, so only the visible ones are submitted
+    ImGuiListClipper folder_clipper;
+    folder_clipper.Begin(shown_folders.size());
+    while (folder_clipper.Step()) {
+        for (int j = folder_clipper.DisplayStart; j < folder_clipper.DisplayEnd; j++) {
+            int i = shown_folders[j];
+            auto& entry = listing->folders[i];
+            auto& folderName = entry.path;
+            bool can_be_loaded = entry.can_be_loaded;
+            ImGui::PushID(i+1);
+            if (!can_be_loaded) {
+                ImGui::PushStyleColor(ImGuiCol_Text, {255, 0, 0, 255});
+                ImGui::PushStyleColor(ImGuiCol_Button, {60, 60, 60, 255});
+                ImGui::PushStyleColor(ImGuiCol_ButtonActive, {60, 60, 60, 255});
+                ImGui::PushStyleColor(ImGuiCol_ButtonHovered, {60, 60, 60, 255});
+            }
+            if (ImGui::Button("Pin") && can_be_loaded) {
+                AddPinnedFolder(folderName);
+            }
             ImGui::SameLine();
-            if (ImGui::Button(saveas ? "Save As" : "Select") && can_be_loaded) {
-                selected = folderName;
-                clicked = true;
+            if (ImGui::Button("Open") && can_be_loaded) {
+                path = folderName;
+                needs_dirlist = true;
+            }
+            if (folder) {
+                ImGui::SameLine();
+                if (ImGui::Button(saveas ? "Save As" : "Select") && can_be_loaded) {
+                    selected = folderName;
+                    clicked = true;
+                }
+            }
+            if (!can_be_loaded) {
+                ImGui::SameLine();
+                ImGui::Text("Has Unicode Characters");
+                ImGui::PopStyleColor(4);
             }
-        }
-        if (!can_be_loaded) {
             ImGui::SameLine();
-            ImGui::Text("Has Unicode Characters");
-            ImGui::PopStyleColor(4);
+            ImGui::TextUnformatted(entry.name.c_str());
+            ImGui::PopID();
         }
-        ImGui::SameLine();
-        ImGui::Text("%s", str.c_str());
-        ImGui::PopID();
     }
 
     if (saveas) {
@@ -202,30 +423,35 @@ bool FileDialog::Show(std::filesystem::path& selected) {
     if (!folder) {
         ImGui::Text("Files");
 
-        for (int i = 0; i < listed_files.size(); i++) {
-            auto& file = listed_files[i];
-            bool can_be_loaded = CanNarrowString16To8(file.filename().wstring());
-            std::string str = NarrowString16To8(file.filename().wstring());
-            ImGui::PushID(i+1+listed_folders.size());
-            if (!can_be_loaded) {
-                ImGui::PushStyleColor(ImGuiCol_Text, {255, 0, 0, 255});
-                ImGui::PushStyleColor(ImGuiCol_Button, {60, 60, 60, 255});
-                ImGui::PushStyleColor(ImGuiCol_ButtonActive, {60, 60, 60, 255});
-                ImGui::PushStyleColor(ImGuiCol_ButtonHovered, {60, 60, 60, 255});
-            }
-            if (ImGui::Button(saveas ? "Save As" : "Open") && can_be_loaded) {
-                selected = file;
-                needs_dirlist = true;
-                clicked = true;
-            }
-            if (!can_be_loaded) {
+        ImGuiListClipper file_clipper;
+        file_clipper.Begin(shown_files.size());
+        while (file_clipper.Step()) {
+            for (int j = file_clipper.DisplayStart; j < file_clipper.DisplayEnd; j++) {
+                int i = shown_files[j];
+                auto& entry = listing->files[i];
+                auto& file = entry.path;
+                bool can_be_loaded = entry.can_be_loaded;
+                ImGui::PushID(i+1+listing->folders.size());
+                if (!can_be_loaded) {
+                    ImGui::PushStyleColor(ImGuiCol_Text, {255, 0, 0, 255});
+                    ImGui::PushStyleColor(ImGuiCol_Button, {60, 60, 60, 255});
+                    ImGui::PushStyleColor(ImGuiCol_ButtonActive, {60, 60, 60, 255});
+                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered, {60, 60, 60, 255});
+                }
+                if (ImGui::Button(saveas ? "Save As" : "Open") && can_be_loaded) {
+                    selected = file;
+                    needs_dirlist = true;
+                    clicked = true;
+                }
+                if (!can_be_loaded) {
+                    ImGui::SameLine();
+                    ImGui::Text("Has Unicode Characters");
+                    ImGui::PopStyleColor(4);
+                }
                 ImGui::SameLine();
-                ImGui::Text("Has Unicode Characters");
-                ImGui::PopStyleColor(4);
+                ImGui::TextUnformatted(entry.name.c_str());
+                ImGui::PopID();
             }
-            ImGui::SameLine();
-            ImGui::Text("%s", str.c_str());
-            ImGui::PopID();
         }
     }
     ImGui::End();
@@ -238,7 +464,7 @@ bool FileDialog::Show(std::filesystem::path& selected) {
 
 void FileDialogManager::show() {
     std::filesystem::path selected;
-    for (int i=0; i<this->size(); i++) {
+    for (size_t i=0; i<this->size(); i++) {
         auto& p = this->at(i);
         if (p.second.first != nullptr) {
             if (p.second.first->Show(selected)) {
@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -9,7 +10,26 @@
 namespace FileDialogs {
     std::string NarrowString16To8(std::wstring w);
     std::wstring ExpandString8To16(std::string s);
+    // lowercased copy of s where runs of digits compare by numeric value, so "track2" sorts before "track10".
+    // compute it once per entry and sort by plain comparison of the keys.
+    std::wstring CollationKey(const std::wstring& s);
     std::vector<std::filesystem::path> DirList(std::filesystem::path path, bool folders=false, bool recursive=false);
+    struct DirEntry {
+        std::filesystem::path path;
+        std::string name; // file name as displayed
+        std::string lower; // name lowercased, for the filter box
+        bool can_be_loaded;
+    };
+    struct DirListing {
+        std::vector<DirEntry> folders;
+        std::vector<DirEntry> files;
+        std::string error;
+    };
+    // listings are cached per directory and fetched on a worker thread.
+    // a refresh only lists the directory again if its modification time changed.
+    void RequestDirListing(const std::filesystem::path& path);
+    // the cached listing of path, nullptr if it hasn't been listed yet. pending is set while a refresh is queued or running
+    std::shared_ptr<const DirListing> GetDirListing(const std::filesystem::path& path, bool* pending=nullptr);
     void AddPinnedFolder(std::filesystem::path p);
     std::vector<std::filesystem::path> GetPinnedFolders();
 
@@ -17,9 +37,14 @@ namespace FileDialogs {
         bool needs_dirlist=true, saveas, folder;
         std::filesystem::path path;
         std::string title;
+        char filter[128] = "";
+        std::string applied_filter;
+        const DirListing* filtered_listing=nullptr;
+        std::vector<int> shown_folders, shown_files;
         protected:
-        std::vector<std::filesystem::path> listed_folders;
-        std::vector<std::filesystem::path> listed_files;
+        std::filesystem::path listed_path;
+        std::shared_ptr<const DirListing> listing;
+        bool listing_pending=false;
         public:
         FileDialog(std::string title, std::filesystem::path path, bool saveas=false, bool folder=false) : title(title), path(path), saveas(saveas), folder(folder) {}
         FileDialog(std::string title, bool saveas=false, bool folder=false) : title(title), path(std::filesystem::current_path()), saveas(saveas), folder(folder) {}
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <cstring>
+#include <cwctype>
+#include <fstream>
+#include <system_error>
+
+#include "FolderScanner.hpp"
+#include "FileDialogs.hpp"
+
+FolderScanner::FolderScanner(unsigned int threads) {
+    if (threads == 0) {
+        threads = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+    }
+    for (unsigned int i = 0; i < threads; i++) {
+        _workers.emplace_back(&FolderScanner::work, this);
+    }
+}
+
+FolderScanner::~FolderScanner() {
+    stop();
+}
+
+bool FolderScanner::IsSoundFile(const std::filesystem::path& path) {
+    std::wstring ext = path.extension().wstring();
+    for (auto& c : ext) {
+        c = std::towlower(c);
+    }
+    enum { WAV, OGG, MP3, QOA, XM, MOD } kind;
+    if (ext == L".wav") kind = WAV;
+    else if (ext == L".ogg") kind = OGG;
+    else if (ext == L".mp3") kind = MP3;
+    else if (ext == L".qoa") kind = QOA;
+    else if (ext == L".xm") kind = XM;
+    else if (ext == L".mod") kind = MOD;
+    else return false;
+
+    std::ifstream fd(path, std::ios::binary);
+    if (!fd.is_open()) {
+        return false;
+    }
+    unsigned char header[17] = {0};
+    fd.read((char*)header, sizeof(header));
+    if (fd.gcount() < 4) {
+        return false;
+    }
+    switch (kind) {
+        case WAV:
+            return !memcmp(header, "RIFF", 4) && !memcmp(&header[8], "WAVE", 4);
+        case OGG:
+            return !memcmp(header, "OggS", 4);
+        case MP3:
+            // either an ID3v2 tag or an MPEG frame sync
+            return !memcmp(header, "ID3", 3) || (header[0] == 0xFF && (header[1] & 0xE0) == 0xE0);
+        case QOA:
+            return !memcmp(header, "qoaf", 4);
+        case XM:
+            return !memcmp(header, "Extended Module:", 16);
+        case MOD: {
+            // the format tag sits after the song name, sample headers and pattern table. these are the tags
+            // jar_mod reads a channel count from, old 15 sample modules have none and are left out
+            static const char* tags[] = {
+                "M.K.", "M!K!", "FLT4", "FLT8", "4CHN", "6CHN", "8CHN", "10CH", "12CH", "14CH", "16CH",
+                "18CH", "20CH", "22CH", "24CH", "26CH", "28CH", "30CH", "32CH",
+            };
+            char tag[4];
+            fd.clear();
+            fd.seekg(1080);
+            fd.read(tag, sizeof(tag));
+            if (fd.gcount() < 4) {
+                return false;
+            }
+            for (const char* t : tags) {
+                if (!memcmp(tag, t, 4)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+    return false;
+}
+
+void FolderScanner::work() {
+    while (true) {
+        std::filesystem::path folder;
+        unsigned int generation;
+        {
+            std::unique_lock<std::mutex> guard(_folders_lock);
+            _folders_cv.wait(guard, [this] { return _stopping || !_folders.empty(); });
+            if (_stopping) {
+                return;
+            }
+            folder = std::move(_folders.front());
+            _folders.pop_front();
+            generation = _generation;
+        }
+        std::vector<std::filesystem::path> subfolders;
+        std::vector<std::string> found;
+        std::error_code ec;
+        std::filesystem::directory_iterator iter(folder, std::filesystem::directory_options::skip_permission_denied, ec);
+        for (; !ec && iter != std::filesystem::directory_iterator(); iter.increment(ec)) {
+            auto& entry = *iter;
+            std::error_code ignored;
+            // don't follow links into folders, they can loop back on themselves
+            if (entry.is_symlink(ignored)) {
+                if (entry.is_regular_file(ignored) && IsSoundFile(entry.path())) {
+                    found.push_back(FileDialogs::NarrowString16To8(entry.path().wstring()));
+                }
+                _scanned++;
+            } else if (entry.is_directory(ignored)) {
+                subfolders.push_back(entry.path());
+            } else if (entry.is_regular_file(ignored)) {
+                if (IsSoundFile(entry.path())) {
+                    found.push_back(FileDialogs::NarrowString16To8(entry.path().wstring()));
+                }
+                _scanned++;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> guard(_folders_lock);
+            // results of a folder listed across a cancel() are dropped
+            bool current = !_stopping && generation == _generation;
+            if (current && found.size() > 0) {
+                std::lock_guard<std::mutex> found_guard(_found_lock);
+                _found.insert(_found.end(), found.begin(), found.end());
+                _matched += found.size();
+            }
+            if (current) {
+                for (auto& f : subfolders) {
+                    _folders.push_back(std::move(f));
+                }
+                _pending_folders += subfolders.size();
+            }
+            _pending_folders--;
+        }
+        _folders_cv.notify_all();
+    }
+}
+
+void FolderScanner::scan(std::filesystem::path root) {
+    {
+        std::lock_guard<std::mutex> guard(_folders_lock);
+        if (_stopping) {
+            return;
+        }
+        if (_pending_folders == 0) {
+            _scanned = 0;
+            _matched = 0;
+        }
+        _folders.push_back(root);
+        _pending_folders++;
+    }
+    _folders_cv.notify_one();
+}
+
+size_t FolderScanner::drain(std::vector<std::string>& out, size_t max) {
+    std::lock_guard<std::mutex> guard(_found_lock);
+    size_t count = std::min(max, _found.size());
+    out.insert(out.end(), _found.begin(), _found.begin() + count);
+    _found.erase(_found.begin(), _found.begin() + count);
+    return count;
+}
+
+void FolderScanner::cancel() {
+    {
+        std::lock_guard<std::mutex> guard(_folders_lock);
+        _generation++;
+        _pending_folders -= _folders.size();
+        _folders.clear();
+    }
+    std::lock_guard<std::mutex> guard(_found_lock);
+    _found.clear();
+}
+
+void FolderScanner::stop() {
+    {
+        std::lock_guard<std::mutex> guard(_folders_lock);
+        _stopping = true;
+        _pending_folders -= _folders.size();
+        _folders.clear();
+    }
+    _folders_cv.notify_all();
+    for (auto& t : _workers) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+    _workers.clear();
+}
+
+bool FolderScanner::isBusy() {
+    std::lock_guard<std::mutex> guard(_folders_lock);
+    return _pending_folders > 0;
+}
+
+unsigned int FolderScanner::scanned() {
+    return _scanned;
+}
+
+unsigned int FolderScanner::matched() {
+    return _matched;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// walks a folder tree on a pool of threads looking for files raylib can decode.
+// files are filtered by extension and then by their header bytes, so no decoder is opened here.
+// matches are handed back to the UI thread incrementally through drain().
+class FolderScanner {
+    std::vector<std::thread> _workers;
+    std::deque<std::filesystem::path> _folders;
+    std::vector<std::string> _found;
+    std::mutex _folders_lock, _found_lock;
+    std::condition_variable _folders_cv;
+    unsigned int _pending_folders=0; // queued + being listed
+    unsigned int _generation=0; // bumped by cancel()
+    std::atomic<unsigned int> _scanned{0}, _matched{0};
+    bool _stopping=false;
+    void work();
+    public:
+    FolderScanner(unsigned int threads=0);
+    ~FolderScanner();
+    void scan(std::filesystem::path root);
+    // moves up to max matched paths (utf-8) into out, returns how many were moved
+    size_t drain(std::vector<std::string>& out, size_t max);
+    void cancel();
+    void stop();
+    bool isBusy();
+    unsigned int scanned();
+    unsigned int matched();
+    // cheap check for a supported extension followed by a matching file signature
+    static bool IsSoundFile(const std::filesystem::path& path);
+};
@@ -0,0 +1,299 @@
+#include <system_error>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "../thirdparty/raylib-5.0/src/raylib.h"
+#include "FileDialogs.hpp"
+#include "FolderScanner.hpp"
+#include "FolderWatcher.hpp"
+
+static std::string PathString(const std::filesystem::path& p) {
+    std::string s = FileDialogs::NarrowString16To8(p.wstring());
+    while (s.size() > 1 && (s.back() == '/' || s.back() == '\\')) {
+        s.pop_back();
+    }
+    return s;
+}
+
+FolderWatcher::FolderWatcher() {
+#ifdef __linux__
+    _inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    _thread = std::thread(&FolderWatcher::work, this);
+}
+
+FolderWatcher::~FolderWatcher() {
+    stop();
+}
+
+void FolderWatcher::watch(std::filesystem::path root, bool import_new) {
+    std::lock_guard<std::mutex> guard(_lock);
+    _requests[PathString(root)] = {true, import_new};
+    _cv.notify_one();
+}
+
+void FolderWatcher::unwatch(std::filesystem::path root) {
+    std::lock_guard<std::mutex> guard(_lock);
+    _requests[PathString(root)] = {false, false};
+    _cv.notify_one();
+}
+
+size_t FolderWatcher::poll(std::vector<Event>& out) {
+    std::lock_guard<std::mutex> guard(_lock);
+    size_t count = _ready.size();
+    out.insert(out.end(), _ready.begin(), _ready.end());
+    _ready.clear();
+    return count;
+}
+
+void FolderWatcher::stop() {
+    _stopping = true;
+    _cv.notify_all();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+#ifdef __linux__
+    if (_inotify_fd >= 0) {
+        close(_inotify_fd);
+        _inotify_fd = -1;
+    }
+#endif
+}
+
+void FolderWatcher::work() {
+    if (_inotify_fd < 0) {
+        TraceLog(LOG_INFO, "inotify unavailable, polling watched folders every %d seconds.", (int)POLL_INTERVAL.count());
+    }
+    Clock::time_point last_poll = Clock::now();
+    while (!_stopping) {
+        applyRequests();
+        if (_inotify_fd >= 0) {
+            readNotifications();
+        } else {
+            {
+                std::unique_lock<std::mutex> guard(_lock);
+                _cv.wait_for(guard, std::chrono::milliseconds(100));
+            }
+            if (Clock::now() - last_poll >= POLL_INTERVAL) {
+                pollRoots();
+                last_poll = Clock::now();
+            }
+        }
+        flush();
+    }
+}
+
+void FolderWatcher::applyRequests() {
+    std::map<std::string, std::pair<bool, bool>> requests;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        requests.swap(_requests);
+    }
+    for (auto& [root, req] : requests) {
+        if (!req.first) {
+            removeWatches(root);
+            _roots.erase(root);
+            continue;
+        }
+        if (_roots.count(root) > 0) {
+            _roots[root].import_new = req.second;
+            continue;
+        }
+        Root& r = _roots[root];
+        r.import_new = req.second;
+        if (_inotify_fd >= 0) {
+            addWatchTree(root, root, false);
+        }
+        std::error_code ec;
+        auto options = std::filesystem::directory_options::skip_permission_denied;
+        for (std::filesystem::recursive_directory_iterator iter(root, options, ec), end; !ec && iter != end; iter.increment(ec)) {
+            std::error_code ignored;
+            if (iter->is_regular_file(ignored)) {
+                auto t = iter->last_write_time(ignored);
+                r.snapshot[PathString(iter->path())] = {iter->file_size(ignored), t.time_since_epoch().count()};
+            }
+        }
+    }
+}
+
+void FolderWatcher::addWatchTree(const std::string& folder, const std::string& root, bool report_files) {
+#ifdef __linux__
+    const uint32_t mask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_ONLYDIR;
+    int wd = inotify_add_watch(_inotify_fd, folder.c_str(), mask);
+    if (wd < 0) {
+        TraceLog(LOG_WARNING, "Failed to watch folder \"%s\"", folder.c_str());
+        return;
+    }
+    _watches[wd] = {folder, root};
+    bool import_new = _roots[root].import_new;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator iter(folder, ec), end; !ec && iter != end; iter.increment(ec)) {
+        std::error_code ignored;
+        if (iter->is_symlink(ignored)) {
+            continue;
+        }
+        if (iter->is_directory(ignored)) {
+            addWatchTree(PathString(iter->path()), root, report_files);
+        } else if (report_files && iter->is_regular_file(ignored)) {
+            // files that landed in a new folder before its watch was added
+            std::string path = PathString(iter->path());
+            remember(_roots[root], path);
+            queue(Event::Changed, path, import_new);
+        }
+    }
+#endif
+}
+
+void FolderWatcher::removeWatches(const std::string& root) {
+#ifdef __linux__
+    for (auto it = _watches.begin(); it != _watches.end();) {
+        if (it->second.second == root) {
+            inotify_rm_watch(_inotify_fd, it->first);
+            it = _watches.erase(it);
+        } else {
+            it++;
+        }
+    }
+#endif
+}
+
+void FolderWatcher::readNotifications() {
+#ifdef __linux__
+    struct pollfd pfd = {_inotify_fd, POLLIN, 0};
+    if (::poll(&pfd, 1, 100) <= 0) {
+        return;
+    }
+    alignas(struct inotify_event) char buffer[16384];
+    ssize_t len;
+    bool overflowed = false;
+    while ((len = read(_inotify_fd, buffer, sizeof(buffer))) > 0) {
+        for (char* ptr = buffer; ptr < buffer + len;) {
+            auto* ev = (struct inotify_event*)ptr;
+            ptr += sizeof(struct inotify_event) + ev->len;
+            if (ev->mask & IN_Q_OVERFLOW) {
+                overflowed = true;
+                continue;
+            }
+            auto it = _watches.find(ev->wd);
+            if (it == _watches.end()) {
+                continue;
+            }
+            if (ev->mask & (IN_IGNORED | IN_DELETE_SELF)) {
+                _watches.erase(it);
+                continue;
+            }
+            if (ev->len == 0) {
+                continue;
+            }
+            std::string folder = it->second.first, root = it->second.second;
+            bool import_new = _roots.count(root) > 0 && _roots[root].import_new;
+            std::string path = folder + "/" + ev->name;
+            auto r = _roots.find(root);
+            if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                if (r != _roots.end()) {
+                    if (ev->mask & IN_ISDIR) {
+                        std::string prefix = path + "/";
+                        auto first = r->second.snapshot.lower_bound(prefix);
+                        auto last = first;
+                        while (last != r->second.snapshot.end() && last->first.compare(0, prefix.size(), prefix) == 0) {
+                            last++;
+                        }
+                        r->second.snapshot.erase(first, last);
+                    } else {
+                        r->second.snapshot.erase(path);
+                    }
+                }
+                queue((ev->mask & IN_ISDIR) ? Event::FolderRemoved : Event::Removed, path, import_new);
+            } else if (ev->mask & IN_ISDIR) {
+                if (ev->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    addWatchTree(path, root, true);
+                }
+            } else if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                if (r != _roots.end()) {
+                    remember(r->second, path);
+                }
+                queue(Event::Changed, path, import_new);
+            }
+        }
+    }
+    if (overflowed) {
+        // events were dropped, rewatch the trees for folders that were missed and diff them like the polling fallback
+        TraceLog(LOG_WARNING, "Too many changes in watched folders at once, rescanning them.");
+        for (auto& [root, r] : _roots) {
+            addWatchTree(root, root, false);
+        }
+        pollRoots();
+    }
+#endif
+}
+
+void FolderWatcher::remember(Root& r, const std::string& path) {
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(path, ec);
+    auto t = std::filesystem::last_write_time(path, ec);
+    if (!ec) {
+        r.snapshot[path] = {size, t.time_since_epoch().count()};
+    }
+}
+
+void FolderWatcher::pollRoots() {
+    for (auto& [root, r] : _roots) {
+        std::map<std::string, std::pair<uintmax_t, int64_t>> snapshot;
+        std::error_code ec;
+        auto options = std::filesystem::directory_options::skip_permission_denied;
+        for (std::filesystem::recursive_directory_iterator iter(root, options, ec), end; !ec && iter != end; iter.increment(ec)) {
+            std::error_code ignored;
+            if (!iter->is_regular_file(ignored)) {
+                continue;
+            }
+            auto t = iter->last_write_time(ignored);
+            std::string path = PathString(iter->path());
+            auto& entry = snapshot[path] = {iter->file_size(ignored), t.time_since_epoch().count()};
+            auto old = r.snapshot.find(path);
+            if (old == r.snapshot.end() || old->second != entry) {
+                queue(Event::Changed, path, r.import_new);
+            }
+        }
+        if (ec) {
+            // the root itself is gone or unreadable, keep the old snapshot until it comes back
+            continue;
+        }
+        for (auto& [path, entry] : r.snapshot) {
+            if (snapshot.count(path) == 0) {
+                queue(Event::Removed, path, r.import_new);
+            }
+        }
+        r.snapshot.swap(snapshot);
+    }
+}
+
+void FolderWatcher::queue(Event::Kind kind, const std::string& path, bool import_new) {
+    Pending& p = _pending[path];
+    p.kind = kind;
+    p.import_new = import_new;
+    p.last = Clock::now();
+}
+
+void FolderWatcher::flush() {
+    Clock::time_point now = Clock::now();
+    std::vector<Event> settled;
+    for (auto it = _pending.begin(); it != _pending.end();) {
+        if (now - it->second.last < DEBOUNCE) {
+            it++;
+            continue;
+        }
+        if (it->second.kind != Event::Changed || FolderScanner::IsSoundFile(it->first)) {
+            settled.push_back({it->second.kind, it->first, it->second.import_new});
+        }
+        it = _pending.erase(it);
+    }
+    if (settled.size() > 0) {
+        std::lock_guard<std::mutex> guard(_lock);
+        _ready.insert(_ready.end(), settled.begin(), settled.end());
+        WakeEventWaiting();
+    }
+}
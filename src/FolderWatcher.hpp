@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// watches folder trees for sound files being added, changed or removed.
+// uses inotify where available and falls back to periodically rescanning the trees.
+// events are debounced per path so a file being copied in is reported once it has settled.
+class FolderWatcher {
+    public:
+    struct Event {
+        enum Kind {
+            Changed, // created, replaced or rewritten, only reported for sound files
+            Removed,
+            FolderRemoved, // everything under the path is gone
+        } kind;
+        std::string path;
+        bool import_new; // whether the root this came from imports files it didn't already have
+    };
+    static constexpr auto DEBOUNCE = std::chrono::milliseconds(300);
+    static constexpr auto POLL_INTERVAL = std::chrono::seconds(2);
+    private:
+    using Clock = std::chrono::steady_clock;
+    struct Root {
+        bool import_new;
+        // last seen size and mtime of every file, diffed by the polling fallback and after the inotify queue overflowed
+        std::map<std::string, std::pair<uintmax_t, int64_t>> snapshot;
+    };
+    struct Pending {
+        Event::Kind kind;
+        bool import_new;
+        Clock::time_point last;
+    };
+    std::thread _thread;
+    std::mutex _lock;
+    std::condition_variable _cv;
+    std::map<std::string, Root> _roots; // only touched by the watcher thread
+    std::map<std::string, std::pair<bool, bool>> _requests; // root -> (watch or unwatch, import_new)
+    std::map<std::string, Pending> _pending;
+    std::vector<Event> _ready;
+    std::map<int, std::pair<std::string, std::string>> _watches; // inotify wd -> (folder, root)
+    int _inotify_fd=-1;
+    std::atomic<bool> _stopping{false};
+    void work();
+    void applyRequests();
+    void addWatchTree(const std::string& folder, const std::string& root, bool report_files);
+    void removeWatches(const std::string& root);
+    void readNotifications();
+    void pollRoots();
+    void remember(Root& r, const std::string& path);
+    void queue(Event::Kind kind, const std::string& path, bool import_new);
+    void flush();
+    public:
+    FolderWatcher();
+    ~FolderWatcher();
+    void watch(std::filesystem::path root, bool import_new);
+    void unwatch(std::filesystem::path root);
+    // moves every settled event into out
+    size_t poll(std::vector<Event>& out);
+    void stop();
+};
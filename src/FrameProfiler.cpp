@@ -0,0 +1,113 @@
+#include "FrameProfiler.hpp"
+
+#if !PRODUCTION_BUILD
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "../thirdparty/imgui-docking/imgui/imgui.h"
+
+FrameProfiler::Section& FrameProfiler::section(const char* name) {
+    for (auto& s : _sections) {
+        if (s.name == name || strcmp(s.name, name) == 0) {
+            return s;
+        }
+    }
+    _sections.push_back({name, 0.0f, std::vector<float>(HISTORY, 0.0f)});
+    return _sections.back();
+}
+
+void FrameProfiler::beginFrame() {
+    _frame_start = _mark = Clock::now();
+    _running = -1;
+}
+
+void FrameProfiler::mark(const char* name) {
+    Clock::time_point now = Clock::now();
+    if (_running >= 0) {
+        _sections[_running].current += std::chrono::duration<float, std::milli>(now - _mark).count();
+    }
+    Section& s = section(name);
+    _running = &s - _sections.data();
+    _mark = now;
+}
+
+void FrameProfiler::record(const char* name, float ms) {
+    section(name).current += ms;
+}
+
+void FrameProfiler::endFrame() {
+    Clock::time_point now = Clock::now();
+    if (_running >= 0) {
+        _sections[_running].current += std::chrono::duration<float, std::milli>(now - _mark).count();
+        _running = -1;
+    }
+    _frames[_head] = std::chrono::duration<float, std::milli>(now - _frame_start).count();
+    for (auto& s : _sections) {
+        s.history[_head] = s.current;
+        s.current = 0.0f;
+    }
+    _head = (_head + 1) % HISTORY;
+    if (_count < HISTORY) {
+        _count++;
+    }
+}
+
+void FrameProfiler::show(bool* open) {
+    if (!ImGui::Begin("Frame Profiler", open)) {
+        ImGui::End();
+        return;
+    }
+    // the ring's oldest frame is at _head once it has wrapped around
+    size_t oldest = _count < HISTORY ? 0 : _head;
+    float worst = 0.0f;
+    for (size_t i = 0; i < _count; i++) {
+        worst = std::max(worst, _frames[i]);
+    }
+    char overlay[64];
+    snprintf(overlay, sizeof(overlay), "last %.2f ms, worst %.2f ms", _frames[(_head + HISTORY - 1) % HISTORY], worst);
+    ImGui::PlotLines("##frame_times", _frames.data(), _count, oldest, overlay, 0.0f, std::max(worst, 16.7f), {-1.0f, 80.0f});
+    ImGui::Text("Frame time includes waiting for events and vsync in EndDrawing.");
+
+    static std::vector<float> sorted;
+    auto stats_row = [&] (const char* name, const std::vector<float>& history) {
+        sorted.assign(history.begin(), history.begin() + _count);
+        float min = 0.0f, avg = 0.0f, p99 = 0.0f;
+        if (_count > 0) {
+            size_t k = (_count * 99 + 99) / 100 - 1;
+            std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+            p99 = sorted[k];
+            min = *std::min_element(sorted.begin(), sorted.end());
+            for (float v : sorted) {
+                avg += v;
+            }
+            avg /= _count;
+        }
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(name);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", history[(_head + HISTORY - 1) % HISTORY]);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", min);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", avg);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", p99);
+    };
+    if (ImGui::BeginTable("##sections", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Section (ms)");
+        ImGui::TableSetupColumn("Last");
+        ImGui::TableSetupColumn("Min");
+        ImGui::TableSetupColumn("Avg");
+        ImGui::TableSetupColumn("P99");
+        ImGui::TableHeadersRow();
+        for (auto& s : _sections) {
+            stats_row(s.name, s.history);
+        }
+        stats_row("Frame", _frames);
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#if !PRODUCTION_BUILD
+#include <chrono>
+#include <string>
+#include <vector>
+
+// times the sections of the frame loop and shows them in a window.
+// mark() closes the running section and starts the next one, so the loop doesn't need extra scopes.
+// use the PROFILE_* macros, they compile out in production builds.
+class FrameProfiler {
+    public:
+    static constexpr size_t HISTORY = 240; // frames
+    private:
+    using Clock = std::chrono::steady_clock;
+    struct Section {
+        const char* name;
+        float current=0.0f; // ms this frame, a section can run more than once per frame
+        std::vector<float> history;
+    };
+    std::vector<Section> _sections;
+    std::vector<float> _frames;
+    size_t _head=0, _count=0; // ring position shared by all histories
+    int _running=-1;
+    Clock::time_point _frame_start, _mark;
+    Section& section(const char* name);
+    public:
+    FrameProfiler() : _frames(HISTORY, 0.0f) {}
+    void beginFrame();
+    void mark(const char* name);
+    // adds time measured elsewhere, e.g. on another thread, to a section of this frame
+    void record(const char* name, float ms);
+    void endFrame();
+    void show(bool* open);
+};
+
+#define PROFILE_BEGIN_FRAME(profiler) (profiler).beginFrame()
+#define PROFILE_MARK(profiler, name) (profiler).mark(name)
+#define PROFILE_RECORD(profiler, name, ms) (profiler).record(name, ms)
+#define PROFILE_END_FRAME(profiler) (profiler).endFrame()
+#else
+#define PROFILE_BEGIN_FRAME(profiler)
+#define PROFILE_MARK(profiler, name)
+#define PROFILE_RECORD(profiler, name, ms)
+#define PROFILE_END_FRAME(profiler)
+#endif
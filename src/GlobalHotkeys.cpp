@@ -0,0 +1,166 @@
+#include <vector>
+
+#ifdef __linux__
+#include <X11/keysym.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include "../thirdparty/raylib-5.0/src/raylib.h"
+#include "GlobalHotkeys.hpp"
+#include "HotkeyBackends.hpp"
+
+GlobalHotkeys::~GlobalHotkeys() {
+    stop();
+}
+
+#ifdef __linux__
+// 0 for keys that can't be bound globally
+static unsigned long KeySym(int key) {
+    // raylib uses ascii for printable keys, which is what the latin-1 keysyms are too
+    if (key >= KEY_A && key <= KEY_Z) {
+        return XK_a + (key - KEY_A);
+    }
+    if (key >= KEY_SPACE && key <= KEY_GRAVE) {
+        return key;
+    }
+    if (key >= KEY_F1 && key <= KEY_F12) {
+        return XK_F1 + (key - KEY_F1);
+    }
+    if (key >= KEY_KP_0 && key <= KEY_KP_9) {
+        return XK_KP_0 + (key - KEY_KP_0);
+    }
+    switch (key) {
+        case KEY_INSERT: return XK_Insert;
+        case KEY_HOME: return XK_Home;
+        case KEY_END: return XK_End;
+        case KEY_PAGE_UP: return XK_Prior;
+        case KEY_PAGE_DOWN: return XK_Next;
+        case KEY_PAUSE: return XK_Pause;
+        case KEY_KP_DECIMAL: return XK_KP_Decimal;
+        case KEY_KP_DIVIDE: return XK_KP_Divide;
+        case KEY_KP_MULTIPLY: return XK_KP_Multiply;
+        case KEY_KP_SUBTRACT: return XK_KP_Subtract;
+        case KEY_KP_ADD: return XK_KP_Add;
+        case KEY_KP_ENTER: return XK_KP_Enter;
+    }
+    return 0;
+}
+
+bool GlobalHotkeys::start(Backend backend, Callback callback) {
+    stop();
+    HotkeyBackend* source = backend == X11 ? CreateX11HotkeyBackend() : CreateEvdevHotkeyBackend();
+    const char* name = backend == X11 ? "X11" : "evdev";
+    if (source == nullptr) {
+        TraceLog(LOG_ERROR, "Global hotkeys: the %s backend isn't available in this build.", name);
+        return false;
+    }
+    std::string error = source->open();
+    if (!error.empty() || pipe(_wake_fds) < 0) {
+        TraceLog(LOG_ERROR, "Global hotkeys: %s backend failed, %s.", name, error.empty() ? "can't create a pipe" : error.c_str());
+        delete source;
+        return false;
+    }
+    for (int fd : _wake_fds) {
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    _backend = source;
+    _callback = callback;
+    _stopping = false;
+    _bindings_changed = true;
+    _thread = std::thread(&GlobalHotkeys::work, this);
+    TraceLog(LOG_INFO, "Global hotkeys: listening with the %s backend.", name);
+    return true;
+}
+
+void GlobalHotkeys::stop() {
+    if (_backend == nullptr) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stopping = true;
+    }
+    char c = 0;
+    (void)!write(_wake_fds[1], &c, 1);
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    delete _backend;
+    _backend = nullptr;
+    for (int& fd : _wake_fds) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+void GlobalHotkeys::setBindings(const std::map<unsigned int, SoundId>& bindings) {
+    std::lock_guard<std::mutex> guard(_lock);
+    _bindings = bindings;
+    _bindings_changed = true;
+    if (_wake_fds[1] >= 0) {
+        char c = 0;
+        (void)!write(_wake_fds[1], &c, 1);
+    }
+}
+
+void GlobalHotkeys::work() {
+    std::vector<pollfd> fds;
+    std::map<unsigned int, SoundId> bindings;
+    std::vector<HotkeyBackend::Key> pressed;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            if (_stopping) {
+                return;
+            }
+            if (_bindings_changed) {
+                _bindings_changed = false;
+                bindings = _bindings;
+                std::vector<HotkeyBackend::Key> keys;
+                for (auto& b : bindings) {
+                    if (unsigned long keysym = KeySym(b.first & ~HOTKEY_MODIFIERS)) {
+                        keys.push_back({keysym, b.first & HOTKEY_MODIFIERS});
+                    }
+                }
+                std::string failed = _backend->grab(keys);
+                if (!failed.empty()) {
+                    TraceLog(LOG_WARNING, "Global hotkeys: %s", failed.c_str());
+                }
+            }
+        }
+        // the backend may already hold queued events (Xlib buffers them), read before sleeping
+        pressed.clear();
+        _backend->read(pressed);
+        Clock::time_point now = Clock::now();
+        for (auto& key : pressed) {
+            for (auto& b : bindings) {
+                if (KeySym(b.first & ~HOTKEY_MODIFIERS) == key.keysym && (b.first & HOTKEY_MODIFIERS) == key.mods) {
+                    _callback(b.second, now);
+                }
+            }
+        }
+        // the backend's descriptors can change, e.g. a keyboard being unplugged
+        fds.clear();
+        fds.push_back({_wake_fds[0], POLLIN, 0});
+        for (int fd : _backend->fds()) {
+            fds.push_back({fd, POLLIN, 0});
+        }
+        if (poll(fds.data(), fds.size(), -1) > 0 && (fds[0].revents & POLLIN)) {
+            char buf[64];
+            while (read(_wake_fds[0], buf, sizeof(buf)) > 0) {}
+        }
+    }
+}
+#else
+bool GlobalHotkeys::start(Backend backend, Callback callback) {
+    TraceLog(LOG_ERROR, "Global hotkeys aren't supported on this platform yet.");
+    return false;
+}
+
+void GlobalHotkeys::stop() {}
+
+void GlobalHotkeys::setBindings(const std::map<unsigned int, SoundId>& bindings) {}
+#endif
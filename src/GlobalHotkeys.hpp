@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "SoundId.hpp"
+
+class HotkeyBackend;
+
+// hotkeys are a raylib key code with these bits or'ed in for the modifiers held with it
+enum HotkeyModifier : unsigned int {
+    HOTKEY_CTRL = 1u << 16,
+    HOTKEY_SHIFT = 1u << 17,
+    HOTKEY_ALT = 1u << 18,
+    HOTKEY_SUPER = 1u << 19,
+    HOTKEY_MODIFIERS = HOTKEY_CTRL | HOTKEY_SHIFT | HOTKEY_ALT | HOTKEY_SUPER,
+};
+
+// system wide hotkeys that fire while another program has focus.
+// a dedicated thread waits on the backend and calls back as soon as a bound key goes down,
+// independent of the window and the frame rate. Linux only for now.
+class GlobalHotkeys {
+    public:
+    enum Backend {
+        X11, // XGrabKey on the root window, the grabbed keys no longer reach other programs
+        Evdev, // reads the keyboards in /dev/input directly, needs read access (usually the input group)
+    };
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void(SoundId id, Clock::time_point pressed)>;
+    private:
+    std::thread _thread;
+    std::mutex _lock;
+    int _wake_fds[2] = {-1, -1};
+    bool _stopping=false, _bindings_changed=false;
+    std::map<unsigned int, SoundId> _bindings;
+    Callback _callback;
+    HotkeyBackend* _backend=nullptr;
+    void work();
+    public:
+    ~GlobalHotkeys();
+    // opens the backend and starts the thread, false (and logged) if the backend isn't available
+    bool start(Backend backend, Callback callback);
+    void stop();
+    bool running() const {
+        return _backend != nullptr;
+    }
+    // hotkey -> sound, replaces the previous bindings
+    void setBindings(const std::map<unsigned int, SoundId>& bindings);
+};
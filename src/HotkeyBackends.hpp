@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// system wide key sources used by GlobalHotkeys, each runs on the hotkey thread only.
+// keys are X keysyms plus HOTKEY_* modifier bits, the backends can't include raylib.h
+// (it clashes with both Xlib and linux/input.h) so GlobalHotkeys translates raylib keys for them.
+class HotkeyBackend {
+    public:
+    struct Key {
+        unsigned long keysym;
+        unsigned int mods;
+        bool operator==(const Key& other) const {
+            return keysym == other.keysym && mods == other.mods;
+        }
+    };
+    virtual ~HotkeyBackend() {}
+    // returns an error message, empty on success
+    virtual std::string open() = 0;
+    // descriptors to poll for input
+    virtual std::vector<int> fds() = 0;
+    // replaces the keys to listen for, returns a message naming any that couldn't be taken
+    virtual std::string grab(const std::vector<Key>& keys) = 0;
+    // appends the grabbed keys that went down since the last call
+    virtual void read(std::vector<Key>& pressed) = 0;
+};
+
+// nullptr when not built for this platform
+HotkeyBackend* CreateX11HotkeyBackend();
+HotkeyBackend* CreateEvdevHotkeyBackend();
@@ -0,0 +1,159 @@
+#include "HotkeyBackends.hpp"
+#include "GlobalHotkeys.hpp"
+
+#ifdef __linux__
+#include <X11/keysym.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <map>
+
+// evdev reports physical keys, this assumes a US layout like the scancode names do
+static const std::map<unsigned short, unsigned long> evdev_keysyms = {
+    {KEY_A, XK_a}, {KEY_B, XK_b}, {KEY_C, XK_c}, {KEY_D, XK_d}, {KEY_E, XK_e}, {KEY_F, XK_f}, {KEY_G, XK_g},
+    {KEY_H, XK_h}, {KEY_I, XK_i}, {KEY_J, XK_j}, {KEY_K, XK_k}, {KEY_L, XK_l}, {KEY_M, XK_m}, {KEY_N, XK_n},
+    {KEY_O, XK_o}, {KEY_P, XK_p}, {KEY_Q, XK_q}, {KEY_R, XK_r}, {KEY_S, XK_s}, {KEY_T, XK_t}, {KEY_U, XK_u},
+    {KEY_V, XK_v}, {KEY_W, XK_w}, {KEY_X, XK_x}, {KEY_Y, XK_y}, {KEY_Z, XK_z},
+    {KEY_1, XK_1}, {KEY_2, XK_2}, {KEY_3, XK_3}, {KEY_4, XK_4}, {KEY_5, XK_5},
+    {KEY_6, XK_6}, {KEY_7, XK_7}, {KEY_8, XK_8}, {KEY_9, XK_9}, {KEY_0, XK_0},
+    {KEY_F1, XK_F1}, {KEY_F2, XK_F2}, {KEY_F3, XK_F3}, {KEY_F4, XK_F4}, {KEY_F5, XK_F5}, {KEY_F6, XK_F6},
+    {KEY_F7, XK_F7}, {KEY_F8, XK_F8}, {KEY_F9, XK_F9}, {KEY_F10, XK_F10}, {KEY_F11, XK_F11}, {KEY_F12, XK_F12},
+    {KEY_KP0, XK_KP_0}, {KEY_KP1, XK_KP_1}, {KEY_KP2, XK_KP_2}, {KEY_KP3, XK_KP_3}, {KEY_KP4, XK_KP_4},
+    {KEY_KP5, XK_KP_5}, {KEY_KP6, XK_KP_6}, {KEY_KP7, XK_KP_7}, {KEY_KP8, XK_KP_8}, {KEY_KP9, XK_KP_9},
+    {KEY_KPDOT, XK_KP_Decimal}, {KEY_KPSLASH, XK_KP_Divide}, {KEY_KPASTERISK, XK_KP_Multiply},
+    {KEY_KPMINUS, XK_KP_Subtract}, {KEY_KPPLUS, XK_KP_Add}, {KEY_KPENTER, XK_KP_Enter},
+    {KEY_SPACE, XK_space}, {KEY_MINUS, XK_minus}, {KEY_EQUAL, XK_equal}, {KEY_LEFTBRACE, XK_bracketleft},
+    {KEY_RIGHTBRACE, XK_bracketright}, {KEY_SEMICOLON, XK_semicolon}, {KEY_APOSTROPHE, XK_apostrophe},
+    {KEY_GRAVE, XK_grave}, {KEY_BACKSLASH, XK_backslash}, {KEY_COMMA, XK_comma}, {KEY_DOT, XK_period},
+    {KEY_SLASH, XK_slash},
+    {KEY_INSERT, XK_Insert}, {KEY_HOME, XK_Home}, {KEY_END, XK_End}, {KEY_PAGEUP, XK_Prior},
+    {KEY_PAGEDOWN, XK_Next}, {KEY_PAUSE, XK_Pause},
+};
+
+static const std::map<unsigned short, unsigned int> evdev_modifiers = {
+    {KEY_LEFTCTRL, HOTKEY_CTRL}, {KEY_RIGHTCTRL, HOTKEY_CTRL},
+    {KEY_LEFTSHIFT, HOTKEY_SHIFT}, {KEY_RIGHTSHIFT, HOTKEY_SHIFT},
+    {KEY_LEFTALT, HOTKEY_ALT}, {KEY_RIGHTALT, HOTKEY_ALT},
+    {KEY_LEFTMETA, HOTKEY_SUPER}, {KEY_RIGHTMETA, HOTKEY_SUPER},
+};
+
+// keys still reach the focused program, nothing is grabbed exclusively
+class EvdevHotkeyBackend : public HotkeyBackend {
+    struct Device {
+        int fd;
+        std::map<unsigned short, bool> held_modifiers;
+    };
+    std::vector<Device> _devices;
+    std::vector<Key> _keys;
+
+    static bool HasBit(const unsigned long* bits, unsigned int bit) {
+        const unsigned int per_long = sizeof(unsigned long) * 8;
+        return (bits[bit / per_long] >> (bit % per_long)) & 1;
+    }
+    public:
+    ~EvdevHotkeyBackend() {
+        for (auto& d : _devices) {
+            close(d.fd);
+        }
+    }
+    std::string open() override {
+        DIR* dir = opendir("/dev/input");
+        if (dir == nullptr) {
+            return "can't open /dev/input";
+        }
+        bool denied = false;
+        while (dirent* entry = readdir(dir)) {
+            if (strncmp(entry->d_name, "event", 5) != 0) {
+                continue;
+            }
+            std::string path = std::string("/dev/input/") + entry->d_name;
+            int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+            if (fd < 0) {
+                denied = true;
+                continue;
+            }
+            // only devices that have letter keys, which leaves out mice, power buttons and the like
+            unsigned long key_bits[KEY_MAX / (sizeof(unsigned long) * 8) + 1] = {};
+            if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(key_bits)), key_bits) < 0 || !HasBit(key_bits, KEY_A) || !HasBit(key_bits, KEY_SPACE)) {
+                close(fd);
+                continue;
+            }
+            _devices.push_back({fd, {}});
+        }
+        closedir(dir);
+        if (_devices.empty()) {
+            return denied ? "no readable keyboard in /dev/input, the user needs to be in the input group" : "no keyboard found in /dev/input";
+        }
+        return "";
+    }
+    std::vector<int> fds() override {
+        std::vector<int> fds;
+        for (auto& d : _devices) {
+            fds.push_back(d.fd);
+        }
+        return fds;
+    }
+    std::string grab(const std::vector<Key>& keys) override {
+        _keys = keys;
+        return "";
+    }
+    void read(std::vector<Key>& pressed) override {
+        input_event events[64];
+        for (auto& d : _devices) {
+            ssize_t n;
+            while ((n = ::read(d.fd, events, sizeof(events))) > 0) {
+                for (size_t i = 0; i < n / sizeof(input_event); i++) {
+                    const input_event& e = events[i];
+                    // value 1 is a press, 2 an auto-repeat and 0 a release
+                    if (e.type != EV_KEY || e.value == 2) {
+                        continue;
+                    }
+                    if (evdev_modifiers.count(e.code) > 0) {
+                        d.held_modifiers[e.code] = e.value == 1;
+                        continue;
+                    }
+                    auto it = evdev_keysyms.find(e.code);
+                    if (e.value != 1 || it == evdev_keysyms.end()) {
+                        continue;
+                    }
+                    unsigned int mods = 0;
+                    for (auto& m : d.held_modifiers) {
+                        if (m.second) {
+                            mods |= evdev_modifiers.at(m.first);
+                        }
+                    }
+                    Key key = {it->second, mods};
+                    for (auto& k : _keys) {
+                        if (k == key) {
+                            pressed.push_back(key);
+                        }
+                    }
+                }
+            }
+            // unplugged
+            if (n < 0 && errno == ENODEV) {
+                close(d.fd);
+                d.fd = -1;
+            }
+        }
+        for (size_t i = _devices.size(); i > 0; i--) {
+            if (_devices[i - 1].fd < 0) {
+                _devices.erase(_devices.begin() + (i - 1));
+            }
+        }
+    }
+};
+
+HotkeyBackend* CreateEvdevHotkeyBackend() {
+    return new EvdevHotkeyBackend();
+}
+#else
+HotkeyBackend* CreateEvdevHotkeyBackend() {
+    return nullptr;
+}
+#endif
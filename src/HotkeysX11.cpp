@@ -0,0 +1,134 @@
+#include "HotkeyBackends.hpp"
+#include "GlobalHotkeys.hpp"
+
+#if defined(__linux__) && HAVE_X11
+#include <X11/XKBlib.h>
+#include <X11/Xlib.h>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+
+// the default Xlib handler exits the process, a key another program already grabbed would take us down with it.
+// the handler is shared by the whole process, so ours is installed once from the thread that also runs the window
+// and only takes the errors of the hotkey connection. the window's errors go on to the handler it replaced
+static std::atomic<Display*> grab_display{nullptr};
+static std::atomic<bool> grab_failed{false};
+static XErrorHandler previous_handler = nullptr;
+static std::once_flag handler_installed;
+
+static int GrabErrorHandler(Display* display, XErrorEvent* error) {
+    if (display == grab_display) {
+        grab_failed = true;
+        return 0;
+    }
+    return previous_handler != nullptr ? previous_handler(display, error) : 0;
+}
+
+class X11HotkeyBackend : public HotkeyBackend {
+    struct Grab {
+        KeyCode keycode;
+        unsigned int mask;
+        Key key;
+    };
+    Display* _display=nullptr;
+    std::vector<Grab> _grabs;
+    std::set<KeyCode> _held;
+
+    static unsigned int Mask(unsigned int mods) {
+        unsigned int mask = 0;
+        if (mods & HOTKEY_CTRL) mask |= ControlMask;
+        if (mods & HOTKEY_SHIFT) mask |= ShiftMask;
+        if (mods & HOTKEY_ALT) mask |= Mod1Mask;
+        if (mods & HOTKEY_SUPER) mask |= Mod4Mask;
+        return mask;
+    }
+    void ungrabAll() {
+        Window root = DefaultRootWindow(_display);
+        for (auto& g : _grabs) {
+            XUngrabKey(_display, g.keycode, AnyModifier, root);
+        }
+        _grabs.clear();
+    }
+    public:
+    ~X11HotkeyBackend() {
+        if (_display != nullptr) {
+            ungrabAll();
+            XSync(_display, False);
+            grab_display = nullptr;
+            XCloseDisplay(_display);
+        }
+    }
+    std::string open() override {
+        // a connection of our own, only ever used from the hotkey thread
+        _display = XOpenDisplay(nullptr);
+        if (_display == nullptr) {
+            return "can't connect to the X server";
+        }
+        grab_display = _display;
+        std::call_once(handler_installed, [] {
+            previous_handler = XSetErrorHandler(GrabErrorHandler);
+        });
+        // report a held key once instead of a press per auto-repeat
+        Bool supported;
+        XkbSetDetectableAutoRepeat(_display, True, &supported);
+        return "";
+    }
+    std::vector<int> fds() override {
+        return {ConnectionNumber(_display)};
+    }
+    std::string grab(const std::vector<Key>& keys) override {
+        ungrabAll();
+        _held.clear();
+        std::string failed;
+        Window root = DefaultRootWindow(_display);
+        for (auto& key : keys) {
+            KeyCode keycode = XKeysymToKeycode(_display, key.keysym);
+            if (keycode == 0) {
+                continue;
+            }
+            unsigned int mask = Mask(key.mods);
+            grab_failed = false;
+            // caps lock and num lock shouldn't change whether the hotkey fires
+            for (unsigned int ignored : {0u, (unsigned int)LockMask, (unsigned int)Mod2Mask, (unsigned int)(LockMask | Mod2Mask)}) {
+                XGrabKey(_display, keycode, mask | ignored, root, True, GrabModeAsync, GrabModeAsync);
+            }
+            XSync(_display, False);
+            if (grab_failed) {
+                XUngrabKey(_display, keycode, AnyModifier, root);
+                const char* name = XKeysymToString(key.keysym);
+                failed += failed.empty() ? "" : ", ";
+                failed += name != nullptr ? name : "?";
+                continue;
+            }
+            _grabs.push_back({keycode, mask, key});
+        }
+        XFlush(_display);
+        return failed.empty() ? "" : "already taken by another program: " + failed;
+    }
+    void read(std::vector<Key>& pressed) override {
+        const unsigned int relevant = ControlMask | ShiftMask | Mod1Mask | Mod4Mask;
+        while (XPending(_display) > 0) {
+            XEvent event;
+            XNextEvent(_display, &event);
+            if (event.type == KeyRelease) {
+                _held.erase(event.xkey.keycode);
+            } else if (event.type == KeyPress && _held.insert(event.xkey.keycode).second) {
+                for (auto& g : _grabs) {
+                    if (g.keycode == event.xkey.keycode && g.mask == (event.xkey.state & relevant)) {
+                        pressed.push_back(g.key);
+                    }
+                }
+            }
+        }
+    }
+};
+
+HotkeyBackend* CreateX11HotkeyBackend() {
+    return new X11HotkeyBackend();
+}
+#else
+HotkeyBackend* CreateX11HotkeyBackend() {
+    return nullptr;
+}
+#endif
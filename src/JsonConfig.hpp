@@ -5,67 +5,110 @@
 #include <raylib.h>
 #include <fstream>
 
+#include "AtomicFile.hpp"
+#include "ConfigCache.hpp"
+
 class JsonConfig {
     std::string _filename;
     nlohmann::json _defaults;
     nlohmann::json _data;
+    bool _dirty=false; // set() changed something since the last save
+    bool _loaded=false; // the constructor found a config to load
     public:
     JsonConfig(std::string filename, nlohmann::json defaults) {
         _filename = filename;
         _defaults = defaults;
         _data = _defaults;
-        load();
+        _loaded = load();
     }
     JsonConfig(std::string filename) {
         _filename = filename;
     }
-    bool load() {
-        std::ifstream fd(_filename);
+    // json stays the format to edit by hand, the ConfigCache copy is what normally gets loaded
+    static bool ReadText(const std::string& filename, nlohmann::json& data) {
+        std::ifstream fd(filename);
         if (fd.is_open()) {
             try {
-                fd >> _data;
+                data = nlohmann::json::parse(fd);
             } catch (nlohmann::detail::exception err) {
-                TraceLog(LOG_WARNING, "Failed to load json from file %s: %s", _filename.c_str(), err.what());
+                TraceLog(LOG_WARNING, "Failed to load json from file %s: %s", filename.c_str(), err.what());
                 return false;
             }
-            fd.close();
             return true;
         }
         return false;
     }
+    static bool Write(const std::string& filename, const nlohmann::json& data) {
+        if (!WriteFileAtomic(filename, Serialize(data))) {
+            return false;
+        }
+        if (!ConfigCache::Write(filename, data)) {
+            TraceLog(LOG_WARNING, "Failed to save %s", ConfigCache::Filename(filename).c_str());
+        }
+        return true;
+    }
+    static std::string Serialize(const nlohmann::json& data) {
+        return data.dump(1, '\t', false, nlohmann::detail::error_handler_t::ignore);
+    }
+    bool load() {
+        return ConfigCache::Read(_filename, _data) || ReadText(_filename, _data);
+    }
     bool save() {
-        std::ofstream fd(_filename);
-        if (fd.is_open()) {
-            fd << _data.dump(1, '\t', false, nlohmann::detail::error_handler_t::ignore);
-            fd.close();
+        if (Write(_filename, _data)) {
+            _dirty = false;
             return true;
         }
+        TraceLog(LOG_WARNING, "Failed to save json to file %s", _filename.c_str());
         return false;
     }
+    bool loaded() const {
+        return _loaded;
+    }
+    const std::string& filename() const {
+        return _filename;
+    }
+    const nlohmann::json& data() const {
+        return _data;
+    }
+    bool dirty() const {
+        return _dirty;
+    }
+    // for a caller that saved data() by itself
+    void markSaved() {
+        _dirty = false;
+    }
     template<class T>
-    T get(std::string key) {
+    T get(const std::string& key) const {
         try {
-            return _data[key].get<T>();
+            return (*this)[key].get<T>();
         } catch (nlohmann::detail::exception err) {
             TraceLog(LOG_WARNING, "Failed to get key %s: %s", key.c_str(), err.what());
             return T();
         }
     }
+    // rvalues are moved in, the big lists in the config are built only to be stored
     template<class T>
-    void set(std::string key, T value) {
+    void set(const std::string& key, T&& value) {
         try {
-            _data[key] = value;
+            nlohmann::json value_json = std::forward<T>(value);
+            auto it = _data.find(key);
+            if (it == _data.end() || *it != value_json) {
+                _data[key] = std::move(value_json);
+                _dirty = true;
+            }
         } catch (nlohmann::detail::exception err) {
             TraceLog(LOG_WARNING, "Failed to set key %s: %s", key.c_str(), err.what());
         }
     }
-    bool contains(std::string key) {
+    bool contains(const std::string& key) const {
         return _data.contains(key);
     }
-    nlohmann::json operator[](std::string key) {
-        return _data[key];
+    // null for a missing key
+    const nlohmann::json& operator[](const std::string& key) const {
+        static const nlohmann::json null;
+        auto it = _data.find(key);
+        return it == _data.end() ? null : *it;
     }
-
 };
 
 #endif
\ No newline at end of file
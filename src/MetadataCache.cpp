@@ -0,0 +1,100 @@
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#include "../include/nlohmann/json.hpp"
+#include "../thirdparty/raylib-5.0/src/raylib.h"
+#include "AtomicFile.hpp"
+#include "MetadataCache.hpp"
+
+static bool StatFile(const std::string& path, uintmax_t& size, int64_t& mtime) {
+    std::error_code ec;
+    size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    auto t = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return false;
+    }
+    mtime = t.time_since_epoch().count();
+    return true;
+}
+
+bool MetadataCache::load() {
+    std::ifstream fd(_filename);
+    if (!fd.is_open()) {
+        return false;
+    }
+    nlohmann::json json;
+    try {
+        fd >> json;
+    } catch (nlohmann::detail::exception err) {
+        TraceLog(LOG_WARNING, "Failed to load metadata cache %s: %s", _filename.c_str(), err.what());
+        return false;
+    }
+    if (!json.is_object()) {
+        return false;
+    }
+    for (auto& [path, e] : json.items()) {
+        try {
+            Entry entry;
+            entry.size = e["sz"].get<uintmax_t>();
+            entry.mtime = e["mt"].get<int64_t>();
+            entry.metadata.length = e["l"].get<float>();
+            entry.metadata.channels = e["c"].get<unsigned int>();
+            entry.metadata.sample_rate = e["sr"].get<unsigned int>();
+            entry.metadata.sample_size = e["ss"].get<unsigned int>();
+            _entries[path] = entry;
+        } catch (nlohmann::detail::exception err) {
+            // skip malformed entries, they will be probed again
+        }
+    }
+    return true;
+}
+
+bool MetadataCache::save() {
+    if (!_dirty) {
+        return true;
+    }
+    nlohmann::json json = nlohmann::json::object();
+    for (auto& [path, entry] : _entries) {
+        json[path] = {
+            {"sz", entry.size},
+            {"mt", entry.mtime},
+            {"l", entry.metadata.length},
+            {"c", entry.metadata.channels},
+            {"sr", entry.metadata.sample_rate},
+            {"ss", entry.metadata.sample_size},
+        };
+    }
+    if (WriteFileAtomic(_filename, json.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore))) {
+        _dirty = false;
+        return true;
+    }
+    return false;
+}
+
+bool MetadataCache::lookup(const std::string& path, SoundMetadata& metadata) {
+    auto it = _entries.find(path);
+    if (it == _entries.end()) {
+        return false;
+    }
+    uintmax_t size;
+    int64_t mtime;
+    if (!StatFile(path, size, mtime) || size != it->second.size || mtime != it->second.mtime) {
+        return false;
+    }
+    metadata = it->second.metadata;
+    return metadata.valid();
+}
+
+void MetadataCache::store(const std::string& path, const SoundMetadata& metadata) {
+    Entry entry;
+    if (!metadata.valid() || !StatFile(path, entry.size, entry.mtime)) {
+        return;
+    }
+    entry.metadata = metadata;
+    _entries[path] = entry;
+    _dirty = true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// stream properties of a sound file, enough to list it without opening a decoder
+struct SoundMetadata {
+    float length=0.0f;
+    unsigned int channels=0, sample_rate=0, sample_size=0;
+    bool valid() const {
+        return sample_rate > 0;
+    }
+};
+
+// on-disk cache of SoundMetadata keyed by path, invalidated when the file size or mtime changes
+class MetadataCache {
+    struct Entry {
+        uintmax_t size;
+        int64_t mtime;
+        SoundMetadata metadata;
+    };
+    std::string _filename;
+    std::unordered_map<std::string, Entry> _entries;
+    bool _dirty=false;
+    public:
+    MetadataCache(std::string filename) : _filename(filename) {}
+    bool load();
+    bool save();
+    // returns true and fills metadata if the file is cached and unchanged since
+    bool lookup(const std::string& path, SoundMetadata& metadata);
+    void store(const std::string& path, const SoundMetadata& metadata);
+};
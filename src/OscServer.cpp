@@ -0,0 +1,354 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifndef WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "OscServer.hpp"
+
+OscServer::~OscServer() {
+    stop();
+}
+
+#ifndef WIN32
+// everything in a packet is big endian and padded to 4 bytes
+static size_t Padded(size_t n) {
+    return (n + 3) & ~(size_t)3;
+}
+
+static uint32_t ReadU32(const char* p) {
+    const unsigned char* u = (const unsigned char*)p;
+    return ((uint32_t)u[0] << 24) | ((uint32_t)u[1] << 16) | ((uint32_t)u[2] << 8) | u[3];
+}
+
+static uint64_t ReadU64(const char* p) {
+    return ((uint64_t)ReadU32(p) << 32) | ReadU32(p + 4);
+}
+
+// bytes taken by the string at data including its padding, 0 if it isn't terminated
+static size_t ReadString(const char* data, size_t size, std::string& out) {
+    const char* end = (const char*)memchr(data, 0, size);
+    if (end == nullptr) {
+        return 0;
+    }
+    out.assign(data, end - data);
+    return std::min(Padded(end - data + 1), size);
+}
+
+bool OscServer::start(const std::string& address, int port) {
+    stop();
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (port < 0 || port > 65535 || inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        TraceLog(LOG_ERROR, "OSC server: \"%s\" port %d isn't an IPv4 address and port.", address.c_str(), port);
+        return false;
+    }
+    _fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (_fd < 0 || bind(_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || pipe(_wake_fds) < 0) {
+        TraceLog(LOG_ERROR, "OSC server: can't listen on %s:%d, %s", address.c_str(), port, strerror(errno));
+        stop();
+        return false;
+    }
+    for (int fd : _wake_fds) {
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    socklen_t length = sizeof(addr);
+    getsockname(_fd, (sockaddr*)&addr, &length);
+    _port = ntohs(addr.sin_port);
+    _stopping = false;
+    _thread = std::thread(&OscServer::work, this);
+    TraceLog(LOG_INFO, "OSC server: listening on %s:%d", address.c_str(), (int)_port);
+    return true;
+}
+
+void OscServer::stop() {
+    _stopping = true;
+    if (_wake_fds[1] >= 0) {
+        char c = 0;
+        (void)!write(_wake_fds[1], &c, 1);
+    }
+#if !PRODUCTION_BUILD
+    if (_benchmark.joinable()) {
+        _benchmark.join();
+    }
+#endif
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    for (int* fd : {&_fd, &_wake_fds[0], &_wake_fds[1]}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+    _port = 0;
+}
+
+void OscServer::work() {
+    std::vector<char> packet(MAX_PACKET);
+    pollfd fds[2] = {{_wake_fds[0], POLLIN, 0}, {_fd, POLLIN, 0}};
+    while (!_stopping) {
+        if (poll(fds, 2, -1) <= 0) {
+            continue;
+        }
+        if (fds[0].revents & POLLIN) {
+            char buf[64];
+            while (read(_wake_fds[0], buf, sizeof(buf)) > 0) {}
+        }
+        ssize_t n;
+        while ((n = recv(_fd, packet.data(), packet.size(), 0)) >= 0) {
+            AudioEngine::Batch batch;
+            batch.sent = AudioEngine::Clock::now();
+            if (!parse(packet.data(), n, batch, 0)) {
+                TraceLog(LOG_DEBUG, "OSC server: ignored a malformed packet of %d bytes.", (int)n);
+                continue;
+            }
+            post(batch);
+        }
+    }
+}
+
+void OscServer::post(AudioEngine::Batch& batch) {
+    if (batch.count > 0 && !_engine.post(batch)) {
+        TraceLog(LOG_WARNING, "OSC server: the audio engine queue is full, dropped %u commands.", batch.count);
+    }
+    batch.count = 0;
+}
+
+bool OscServer::parse(const char* data, size_t size, AudioEngine::Batch& batch, int depth) {
+    if (size >= 16 && memcmp(data, "#bundle", 8) == 0) {
+        if (depth >= 8) {
+            return false;
+        }
+        // the time tag follows the header, then each element with its size in front
+        size_t pos = 16;
+        while (pos + 4 <= size) {
+            size_t length = ReadU32(data + pos);
+            pos += 4;
+            if (length > size - pos || !parse(data + pos, length, batch, depth + 1)) {
+                return false;
+            }
+            pos += length;
+        }
+        return true;
+    }
+    if (size == 0 || data[0] != '/') {
+        return false;
+    }
+    parseMessage(data, size, batch);
+    return true;
+}
+
+void OscServer::parseMessage(const char* data, size_t size, AudioEngine::Batch& batch) {
+    std::string address, types;
+    size_t pos = ReadString(data, size, address);
+    if (pos == 0) {
+        return;
+    }
+    if (pos < size && data[pos] == ',') {
+        size_t n = ReadString(data + pos, size - pos, types);
+        if (n == 0) {
+            return;
+        }
+        pos += n;
+    }
+    // only the first numeric argument is used
+    bool has_value = false;
+    float value = 0.0f;
+    for (size_t i = 1; i < types.size(); i++) {
+        char t = types[i];
+        size_t length = 0;
+        float v = 0.0f;
+        bool numeric = true;
+        if ((t == 'f' || t == 'i') && pos + 4 <= size) {
+            uint32_t bits = ReadU32(data + pos);
+            if (t == 'f') {
+                memcpy(&v, &bits, sizeof(v));
+            } else {
+                v = (float)(int32_t)bits;
+            }
+            length = 4;
+        } else if ((t == 'd' || t == 'h') && pos + 8 <= size) {
+            uint64_t bits = ReadU64(data + pos);
+            if (t == 'd') {
+                double d;
+                memcpy(&d, &bits, sizeof(d));
+                v = (float)d;
+            } else {
+                v = (float)(int64_t)bits;
+            }
+            length = 8;
+        } else if (t == 'T' || t == 'F') {
+            v = t == 'T' ? 1.0f : 0.0f;
+        } else if (t == 'N' || t == 'I') {
+            numeric = false;
+        } else if ((t == 'c' || t == 'r' || t == 'm') && pos + 4 <= size) {
+            numeric = false;
+            length = 4;
+        } else if (t == 't' && pos + 8 <= size) {
+            numeric = false;
+            length = 8;
+        } else if (t == 's' || t == 'S') {
+            std::string s;
+            numeric = false;
+            if ((length = ReadString(data + pos, size - pos, s)) == 0) {
+                return;
+            }
+        } else if (t == 'b' && pos + 4 <= size) {
+            numeric = false;
+            length = 4 + Padded(ReadU32(data + pos));
+        } else {
+            return;
+        }
+        if (length > size - pos) {
+            return;
+        }
+        pos += length;
+        if (numeric && !has_value) {
+            has_value = true;
+            value = v;
+        }
+    }
+
+    std::vector<std::string> parts;
+    for (size_t start = 1; start <= address.size();) {
+        size_t slash = std::min(address.find('/', start), address.size());
+        parts.push_back(address.substr(start, slash - start));
+        start = slash + 1;
+    }
+    AudioEngine::Command command = {AudioEngine::Command::Play, SoundId(), "", value};
+    if (parts.size() == 3 && parts[0] == "sound" && parts[1].size() < sizeof(command.target)) {
+        strcpy(command.target, parts[1].c_str());
+        if (parts[2] == "play") {
+            // buttons on control surfaces send 1 when pressed and 0 when released
+            if (has_value && value == 0.0f) {
+                return;
+            }
+            command.kind = AudioEngine::Command::Play;
+        } else if (parts[2] == "stop") {
+            command.kind = AudioEngine::Command::Stop;
+        } else if (parts[2] == "volume" && has_value) {
+            command.kind = AudioEngine::Command::Volume;
+        } else {
+            TraceLog(LOG_DEBUG, "OSC server: unknown address \"%s\".", address.c_str());
+            return;
+        }
+    } else if (parts.size() == 2 && parts[0] == "master" && parts[1] == "volume" && has_value) {
+        command.kind = AudioEngine::Command::MasterVolume;
+    } else if (parts.size() == 1 && parts[0] == "stop") {
+        command.kind = AudioEngine::Command::Stop;
+    } else {
+        TraceLog(LOG_DEBUG, "OSC server: unknown address \"%s\".", address.c_str());
+        return;
+    }
+    // a bundle with more commands than a batch holds is split, its sounds may then start a period apart
+    if (batch.count == AudioEngine::MAX_BATCH) {
+        post(batch);
+    }
+    batch.commands[batch.count++] = command;
+}
+
+#if !PRODUCTION_BUILD
+static void AppendString(std::string& out, const std::string& s) {
+    out += s;
+    out.append(4 - s.size() % 4, '\0');
+}
+
+static std::string Message(const std::string& address) {
+    std::string m;
+    AppendString(m, address);
+    AppendString(m, ",");
+    return m;
+}
+
+void OscServer::startBenchmark(int count) {
+    if (_benchmarking || !running()) {
+        return;
+    }
+    if (_benchmark.joinable()) {
+        _benchmark.join();
+    }
+    _benchmarking = true;
+    _benchmark = std::thread(&OscServer::benchmark, this, count);
+}
+
+void OscServer::benchmark(int count) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr = {};
+    socklen_t length = sizeof(addr);
+    getsockname(_fd, (sockaddr*)&addr, &length);
+    if (addr.sin_addr.s_addr == htonl(INADDR_ANY)) {
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    }
+    // a single play, then a bundle playing the first four sounds together
+    std::string single = Message("/sound/0/play");
+    std::string bundle("#bundle\0\0\0\0\0\0\0\0\1", 16);
+    for (int i = 0; i < 4; i++) {
+        std::string m = Message("/sound/" + std::to_string(i) + "/play");
+        uint32_t size = htonl(m.size());
+        bundle.append((const char*)&size, 4);
+        bundle += m;
+    }
+    for (const std::string* packet : {&single, &bundle}) {
+        std::vector<float> samples;
+        for (int i = 0; i < count && !_stopping; i++) {
+            unsigned int before;
+            {
+                std::lock_guard<std::mutex> guard(_engine.mutex());
+                before = _engine.latency().count;
+            }
+            AudioEngine::Clock::time_point sent = AudioEngine::Clock::now();
+            sendto(fd, packet->data(), packet->size(), 0, (sockaddr*)&addr, sizeof(addr));
+            // the engine measures up to the first mixed period, polled here until it has
+            while (AudioEngine::Clock::now() - sent < std::chrono::seconds(1)) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                std::lock_guard<std::mutex> guard(_engine.mutex());
+                if (_engine.latency().count != before) {
+                    samples.push_back(std::chrono::duration<float, std::milli>(_engine.latency().last_mixed - sent).count());
+                    break;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        if (samples.empty()) {
+            TraceLog(LOG_WARNING, "OSC benchmark: nothing was played, the list needs at least one sound.");
+            break;
+        }
+        std::sort(samples.begin(), samples.end());
+        float total = 0.0f;
+        for (float s : samples) {
+            total += s;
+        }
+        TraceLog(LOG_INFO, "OSC benchmark, %s: %d of %d played, message to first mixed sample min %.2f ms, avg %.2f ms, p99 %.2f ms, max %.2f ms",
+            packet == &single ? "single play" : "bundle of 4 plays", (int)samples.size(), count,
+            samples.front(), total / samples.size(), samples[std::min(samples.size() - 1, samples.size() * 99 / 100)], samples.back());
+    }
+    std::string stop = Message("/stop");
+    sendto(fd, stop.data(), stop.size(), 0, (sockaddr*)&addr, sizeof(addr));
+    close(fd);
+    _benchmarking = false;
+}
+#endif
+#else
+bool OscServer::start(const std::string& address, int port) {
+    TraceLog(LOG_ERROR, "The OSC server isn't supported on this platform yet.");
+    return false;
+}
+
+void OscServer::stop() {}
+
+#if !PRODUCTION_BUILD
+void OscServer::startBenchmark(int count) {}
+#endif
+#endif
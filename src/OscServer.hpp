@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "AudioEngine.hpp"
+
+// Open Sound Control over UDP, for control surfaces and other programs on the network.
+// a dedicated thread receives the packets and posts them to the audio engine's queue as they arrive:
+//   /sound/<name|position>/play    restarts the sound, a 0 argument (a button being released) is ignored
+//   /sound/<name|position>/stop
+//   /sound/<name|position>/volume f
+//   /master/volume f
+//   /stop                          stops everything
+// the messages in a bundle are posted as one batch, so the sounds it plays start together.
+// bundle time tags are ignored, everything runs as soon as it arrives.
+class OscServer {
+    public:
+    static constexpr size_t MAX_PACKET = 65536;
+    private:
+    AudioEngine& _engine;
+    std::thread _thread;
+    int _fd=-1;
+    int _wake_fds[2] = {-1, -1};
+    std::atomic<bool> _stopping{false};
+    unsigned short _port=0;
+#if !PRODUCTION_BUILD
+    std::thread _benchmark;
+    std::atomic<bool> _benchmarking{false};
+    void benchmark(int count);
+#endif
+    void work();
+    // appends the commands of a message or bundle, false if it is malformed
+    bool parse(const char* data, size_t size, AudioEngine::Batch& batch, int depth);
+    void parseMessage(const char* data, size_t size, AudioEngine::Batch& batch);
+    void post(AudioEngine::Batch& batch);
+    public:
+    OscServer(AudioEngine& engine) : _engine(engine) {}
+    ~OscServer();
+    // binds the address (an IPv4 address, 0.0.0.0 for every interface) and starts the thread
+    bool start(const std::string& address, int port);
+    void stop();
+    bool running() const {
+        return _fd >= 0;
+    }
+    // the bound port, useful when started with port 0
+    unsigned short port() const {
+        return _port;
+    }
+#if !PRODUCTION_BUILD
+    // sends plays and bundles to the server from a local socket and logs the time until their first samples are mixed
+    void startBenchmark(int count);
+    bool benchmarking() const {
+        return _benchmarking;
+    }
+#endif
+};
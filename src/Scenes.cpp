@@ -0,0 +1,188 @@
+#include <cstdlib>
+
+#include "Scenes.hpp"
+
+Scene Scene::FromJson(const nlohmann::json& json) {
+    Scene scene;
+    if (!json.is_object()) {
+        return scene;
+    }
+    static const nlohmann::json none = nlohmann::json::object();
+    auto configs = json.find("sound_configs");
+    const nlohmann::json& sound_configs = configs != json.end() && configs->is_object() ? *configs : none;
+    auto sounds = json.find("loaded_sounds");
+    if (sounds != json.end() && sounds->is_array()) {
+        scene.sounds.reserve(sounds->size());
+        for (auto& p : *sounds) {
+            if (!p.is_string()) {
+                continue;
+            }
+            const std::string& path = p.get_ref<const std::string&>();
+            auto cfg = sound_configs.find(path);
+            scene.sounds.emplace_back(path, cfg != sound_configs.end() ? SoundSettings::FromJson(*cfg) : SoundSettings());
+        }
+    }
+    auto keybinds = json.find("sound_keybinds");
+    if (keybinds != json.end() && keybinds->is_object()) {
+        for (auto& [key, path] : keybinds->items()) {
+            if (path.is_string()) {
+                scene.keybinds[strtoul(key.c_str(), nullptr, 10)] = path.get<std::string>();
+            }
+        }
+    }
+    auto volume = json.find("global_volume");
+    if (volume != json.end() && volume->is_number()) {
+        scene.volume = volume->get<float>();
+    }
+    return scene;
+}
+
+nlohmann::json Scene::toJson() const {
+    nlohmann::json paths = nlohmann::json::array();
+    nlohmann::json sound_configs = nlohmann::json::object();
+    for (auto& [path, settings] : sounds) {
+        paths.push_back(path);
+        sound_configs[path] = settings.toJson();
+    }
+    nlohmann::json saved_keybinds = nlohmann::json::object();
+    for (auto& [key, path] : keybinds) {
+        saved_keybinds[std::to_string(key)] = path;
+    }
+    return {
+        {"loaded_sounds", std::move(paths)},
+        {"sound_configs", std::move(sound_configs)},
+        {"sound_keybinds", std::move(saved_keybinds)},
+        {"global_volume", volume},
+    };
+}
+
+void SceneWarmer::start() {
+    _stopping = false;
+    _thread = std::thread(&SceneWarmer::work, this);
+}
+
+void SceneWarmer::stop() {
+    if (_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            _stopping = true;
+            _jobs.clear();
+        }
+        _cv.notify_all();
+        _thread.join();
+    }
+    dropReady();
+    for (ConfiguredMusic* music : _discarded) {
+        music->Unload();
+        delete music;
+    }
+    _discarded.clear();
+}
+
+// with the lock held
+void SceneWarmer::dropReady() {
+    for (auto& [path, music] : _ready) {
+        _discarded.push_back(music);
+    }
+    _ready.clear();
+}
+
+void SceneWarmer::work() {
+    std::unique_lock<std::mutex> guard(_lock);
+    while (true) {
+        _cv.wait(guard, [this] { return _stopping || !_jobs.empty() || !_discarded.empty(); });
+        if (!_discarded.empty()) {
+            std::vector<ConfiguredMusic*> discarded;
+            discarded.swap(_discarded);
+            guard.unlock();
+            for (ConfiguredMusic* music : discarded) {
+                music->Unload();
+                delete music;
+            }
+            guard.lock();
+            continue;
+        }
+        if (_stopping) {
+            return;
+        }
+        Job job = std::move(_jobs.front());
+        _jobs.pop_front();
+        uint32_t generation = _generation;
+        _working = true;
+        guard.unlock();
+        // a file that can't be opened is still listed, the same as at startup
+        ConfiguredMusic* music = job.open ? ConfiguredMusic::Load(job.path, job.settings, true, job.metadata) : nullptr;
+        if (music == nullptr) {
+            music = ConfiguredMusic::LoadLazy(job.path, job.settings, job.metadata);
+        }
+        guard.lock();
+        _working = false;
+        if (generation != _generation || _ready.count(job.path) > 0) {
+            _discarded.push_back(music);
+        } else {
+            _ready[job.path] = music;
+        }
+    }
+}
+
+void SceneWarmer::warm(const std::string& scene, std::vector<Job> jobs) {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _generation++;
+        dropReady();
+        _scene = scene;
+        _jobs.assign(std::make_move_iterator(jobs.begin()), std::make_move_iterator(jobs.end()));
+        _total = _jobs.size();
+    }
+    _cv.notify_all();
+}
+
+void SceneWarmer::cancel() {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _generation++;
+        dropReady();
+        _scene.clear();
+        _jobs.clear();
+        _total = 0;
+    }
+    _cv.notify_all();
+}
+
+ConfiguredMusic* SceneWarmer::take(const std::string& scene, const std::string& path) {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (scene != _scene) {
+        return nullptr;
+    }
+    auto it = _ready.find(path);
+    if (it == _ready.end()) {
+        return nullptr;
+    }
+    ConfiguredMusic* music = it->second;
+    _ready.erase(it);
+    return music;
+}
+
+void SceneWarmer::discard(std::vector<ConfiguredMusic*> music) {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _discarded.insert(_discarded.end(), music.begin(), music.end());
+    }
+    _cv.notify_all();
+}
+
+std::string SceneWarmer::scene() {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _scene;
+}
+
+bool SceneWarmer::isBusy() {
+    std::lock_guard<std::mutex> guard(_lock);
+    return !_jobs.empty() || _working || !_discarded.empty();
+}
+
+void SceneWarmer::progress(size_t& ready, size_t& total) {
+    std::lock_guard<std::mutex> guard(_lock);
+    ready = _ready.size();
+    total = _total;
+}
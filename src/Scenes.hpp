@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../include/nlohmann/json.hpp"
+#include "ConfiguredMusic.hpp"
+#include "SoundSettings.hpp"
+
+// a named board that isn't on screen: its sounds in display order with their settings, its hotkeys and
+// its master volume. saved under "scenes" with the same keys the active board uses at the top of config.json
+struct Scene {
+    std::vector<std::pair<std::string, SoundSettings>> sounds;
+    std::map<unsigned int, std::string> keybinds; // hotkey -> path
+    float volume=1.0f;
+    static Scene FromJson(const nlohmann::json& json);
+    nlohmann::json toJson() const;
+};
+
+// prepares the entries of the scene about to be switched to on its own thread while the current one plays.
+// the UI thread hands it the sounds the board doesn't already list (shared ones stay open across the switch),
+// bound hotkeys and short clips get their decoder opened and preloaded, the rest are listed like at startup.
+// entries a switch drops are also closed here instead of on the UI thread.
+class SceneWarmer {
+    public:
+    static constexpr size_t MAX_OPEN = 64;
+    struct Job {
+        std::string path;
+        SoundSettings settings;
+        SoundMetadata metadata;
+        bool open;
+    };
+    private:
+    std::thread _thread;
+    std::mutex _lock;
+    std::condition_variable _cv;
+    std::string _scene;
+    uint32_t _generation=0; // bumped when the jobs are replaced, older results are discarded
+    std::deque<Job> _jobs;
+    bool _working=false;
+    std::unordered_map<std::string, ConfiguredMusic*> _ready;
+    std::vector<ConfiguredMusic*> _discarded;
+    size_t _total=0;
+    bool _stopping=false;
+    void work();
+    void dropReady();
+    public:
+    ~SceneWarmer() {
+        stop();
+    }
+    void start();
+    // joins and unloads everything still held, must be called before the audio device is closed
+    void stop();
+    // replaces whatever was being prepared
+    void warm(const std::string& scene, std::vector<Job> jobs);
+    void cancel();
+    // the prepared entry for path if scene is the one being warmed and it is ready, the caller owns it
+    ConfiguredMusic* take(const std::string& scene, const std::string& path);
+    // unloads and deletes the entries on the warmer thread
+    void discard(std::vector<ConfiguredMusic*> music);
+    std::string scene();
+    bool isBusy();
+    void progress(size_t& ready, size_t& total);
+};
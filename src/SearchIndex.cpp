@@ -0,0 +1,350 @@
+#include <algorithm>
+
+#include "SearchIndex.hpp"
+
+static std::string Lower(const std::string& s) {
+    std::string out = s;
+    for (auto& c : out) {
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+    }
+    return out;
+}
+
+std::vector<uint32_t> SearchIndex::Trigrams(const std::string& text) {
+    std::vector<uint32_t> grams;
+    if (text.size() < 3) {
+        return grams;
+    }
+    grams.reserve(text.size() - 2);
+    for (size_t i = 0; i + 2 < text.size(); i++) {
+        grams.push_back((uint8_t)text[i] << 16 | (uint8_t)text[i + 1] << 8 | (uint8_t)text[i + 2]);
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+// where w appears in text, npos if it doesn't. words shorter than a trigram only match at the start
+// of a word in the name, otherwise a single letter would match nearly every path
+size_t SearchIndex::Find(const std::string& text, uint32_t name_len, const std::string& w) {
+    size_t pos = text.find(w);
+    while (w.size() < 3 && pos < name_len && !IsWordStart(text, pos)) {
+        pos = text.find(w, pos + 1);
+    }
+    if (pos == std::string::npos || (w.size() < 3 && pos >= name_len)) {
+        return std::string::npos;
+    }
+    return pos;
+}
+
+bool SearchIndex::IsWordStart(const std::string& text, size_t pos) {
+    if (pos == 0) {
+        return true;
+    }
+    char before = text[pos - 1];
+    return before == ' ' || before == '_' || before == '-' || before == '.';
+}
+
+// trigrams only use the low 24 bits, prefixes are tagged above them
+uint32_t SearchIndex::PrefixKey(const std::string& word) {
+    if (word.size() == 1) {
+        return 1u << 24 | (uint8_t)word[0];
+    }
+    return 2u << 24 | (uint8_t)word[0] << 8 | (uint8_t)word[1];
+}
+
+std::vector<uint32_t> SearchIndex::Keys(const std::string& text, uint32_t name_len) {
+    std::vector<uint32_t> keys = Trigrams(text);
+    for (size_t i = 0; i < name_len; i++) {
+        if (IsWordStart(text, i)) {
+            keys.push_back(PrefixKey(text.substr(i, 1)));
+            if (i + 1 < name_len) {
+                keys.push_back(PrefixKey(text.substr(i, 2)));
+            }
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+void SearchIndex::add(SoundId id, const std::string& name, const std::string& path, const std::string& tags) {
+    remove(id);
+    if (id.index >= _docs.size()) {
+        _docs.resize(id.index + 1);
+    }
+    Doc& doc = _docs[id.index];
+    doc.text = Lower(name) + "\n" + Lower(path) + "\n" + Lower(tags);
+    doc.name_len = name.size();
+    doc.generation = id.generation;
+    doc.stamp = _next_stamp++;
+    auto grams = Keys(doc.text, doc.name_len);
+    doc.gram_count = grams.size();
+    for (uint32_t g : grams) {
+        _postings[g].push_back({id.index, doc.stamp});
+    }
+    _live_postings += grams.size();
+}
+
+void SearchIndex::remove(SoundId id) {
+    if (id.index >= _docs.size() || _docs[id.index].generation != id.generation) {
+        return;
+    }
+    Doc& doc = _docs[id.index];
+    _live_postings -= doc.gram_count;
+    _stale_postings += doc.gram_count;
+    doc.text.clear();
+    doc.gram_count = 0;
+    doc.generation = 0;
+    if (_stale_postings > _live_postings) {
+        rebuild();
+    }
+}
+
+void SearchIndex::rebuild() {
+    _postings.clear();
+    _live_postings = 0;
+    _stale_postings = 0;
+    for (uint32_t i = 0; i < _docs.size(); i++) {
+        if (_docs[i].generation == 0) {
+            continue;
+        }
+        for (uint32_t g : Keys(_docs[i].text, _docs[i].name_len)) {
+            _postings[g].push_back({i, _docs[i].stamp});
+        }
+        _live_postings += _docs[i].gram_count;
+    }
+}
+
+void SearchIndex::clear() {
+    _docs.clear();
+    _postings.clear();
+    _live_postings = 0;
+    _stale_postings = 0;
+}
+
+// bit i of masks[c] is set when letter i of the word is c
+std::vector<uint64_t> SearchIndex::Masks(const std::string& word) {
+    std::vector<uint64_t> masks(256, 0);
+    for (size_t i = 0; i < word.size() && i < 64; i++) {
+        masks[(uint8_t)word[i]] |= 1ull << i;
+    }
+    return masks;
+}
+
+// edits needed to turn the word (up to 64 letters, given by its masks and length) into the closest substring
+// of text, adjacent swaps count as one. anything past limit is returned as limit + 1. in_name is the same for
+// substrings of the first name_len characters, when one of those is close enough the rest isn't looked at.
+// the column of the edit distance table is kept as bits of its vertical deltas, one text character per step
+// (Myers' search with Hyyro's transpositions)
+uint32_t SearchIndex::SubstringDistance(const std::vector<uint64_t>& masks, size_t length, const std::string& text, uint32_t name_len, uint32_t limit, uint32_t& in_name) {
+    uint64_t top = 1ull << (length - 1);
+    uint64_t vp = ~0ull, vn = 0, d0 = 0, previous_pm = 0;
+    uint32_t score = length, best = length;
+    in_name = std::min(best, limit + 1);
+    for (size_t j = 0; j < text.size(); j++) {
+        uint64_t pm = masks[(uint8_t)text[j]];
+        d0 = (((~d0 & pm) << 1) & previous_pm) | (((pm & vp) + vp) ^ vp) | pm | vn;
+        uint64_t hp = vn | ~(d0 | vp);
+        uint64_t hn = d0 & vp;
+        if (hp & top) {
+            score++;
+        } else if (hn & top) {
+            score--;
+        }
+        // any text position can start the match, so the first row stays 0
+        uint64_t x = hp << 1;
+        vn = x & d0;
+        vp = (hn << 1) | ~(x | d0);
+        previous_pm = pm;
+        best = std::min(best, score);
+        if (j + 1 == name_len) {
+            in_name = std::min(best, limit + 1);
+            if (in_name <= limit) {
+                break;
+            }
+        }
+    }
+    return std::min(best, limit + 1);
+}
+
+// near misses for a query exact matching found too few entries for. words of four to 64 letters may be
+// off by an edit (two from eight letters), other words still have to match exactly. an edit changes at most
+// four of a word's trigrams, so only entries sharing the rest of them with every word are checked
+void SearchIndex::fuzzy(const std::vector<std::string>& words, std::vector<Hit>& hits) const {
+    std::vector<uint32_t> allowed(words.size(), 0);
+    std::vector<std::vector<uint64_t>> masks(words.size());
+    std::vector<uint32_t> candidates;
+    bool any_fuzzy = false;
+    // trigrams each entry shares with the word, and the entries that share any
+    std::vector<uint8_t> shared(_docs.size());
+    std::vector<uint32_t> touched;
+    for (size_t k = 0; k < words.size(); k++) {
+        const std::string& w = words[k];
+        if (w.size() < 4 || w.size() > 64) {
+            continue;
+        }
+        allowed[k] = w.size() < 8 ? 1 : 2;
+        masks[k] = Masks(w);
+        std::vector<uint32_t> grams = Trigrams(w);
+        uint32_t need = grams.size() > 4 * allowed[k] ? grams.size() - 4 * allowed[k] : 1;
+        for (uint32_t index : touched) {
+            shared[index] = 0;
+        }
+        touched.clear();
+        for (uint32_t g : grams) {
+            auto it = _postings.find(g);
+            if (it == _postings.end()) {
+                continue;
+            }
+            for (const Posting& p : it->second) {
+                const Doc& doc = _docs[p.index];
+                if (doc.generation != 0 && doc.stamp == p.stamp && shared[p.index] < 255) {
+                    if (shared[p.index]++ == 0) {
+                        touched.push_back(p.index);
+                    }
+                }
+            }
+        }
+        std::vector<uint32_t> matched;
+        for (uint32_t index : touched) {
+            if (shared[index] >= need) {
+                matched.push_back(index);
+            }
+        }
+        // a short word can lose every trigram to one edit, entries with a name word starting like it are checked too
+        if (grams.size() <= 4 * allowed[k]) {
+            auto it = _postings.find(PrefixKey(w.substr(0, 2)));
+            if (it != _postings.end()) {
+                for (const Posting& p : it->second) {
+                    const Doc& doc = _docs[p.index];
+                    if (doc.generation != 0 && doc.stamp == p.stamp && shared[p.index] == 0) {
+                        matched.push_back(p.index);
+                    }
+                }
+            }
+        }
+        std::sort(matched.begin(), matched.end());
+        if (!any_fuzzy) {
+            candidates.swap(matched);
+        } else {
+            std::vector<uint32_t> both;
+            std::set_intersection(candidates.begin(), candidates.end(), matched.begin(), matched.end(), std::back_inserter(both));
+            candidates.swap(both);
+        }
+        any_fuzzy = true;
+    }
+    if (!any_fuzzy) {
+        return;
+    }
+    // only a few exact hits get here, a scan over them is cheaper than a set
+    size_t exact = hits.size();
+    for (uint32_t index : candidates) {
+        if (std::any_of(hits.begin(), hits.begin() + exact, [index] (const Hit& hit) { return hit.index == index; })) {
+            continue;
+        }
+        const Doc& doc = _docs[index];
+        uint32_t score = FUZZY_SCORE;
+        bool matched = true;
+        // the exact words are cheaper to rule an entry out with
+        for (size_t k = 0; k < words.size() && matched; k++) {
+            if (allowed[k] == 0) {
+                matched = Find(doc.text, doc.name_len, words[k]) != std::string::npos;
+            }
+        }
+        for (size_t k = 0; k < words.size() && matched; k++) {
+            if (allowed[k] == 0) {
+                continue;
+            }
+            // closer matches first, and the name before the path or tags
+            uint32_t d;
+            uint32_t anywhere = SubstringDistance(masks[k], words[k].size(), doc.text, doc.name_len, allowed[k], d);
+            if (d > allowed[k]) {
+                d = anywhere;
+                score += 1;
+            }
+            matched = d <= allowed[k];
+            score += 2 * d;
+        }
+        if (matched) {
+            hits.push_back({score, doc.name_len, index});
+        }
+    }
+}
+
+std::vector<SoundId> SearchIndex::search(const std::string& query, size_t max) const {
+    std::vector<std::string> words;
+    std::string lowered = Lower(query);
+    for (size_t i = 0; i < lowered.size();) {
+        size_t end = lowered.find(' ', i);
+        if (end == std::string::npos) {
+            end = lowered.size();
+        }
+        if (end > i) {
+            words.push_back(lowered.substr(i, end - i));
+        }
+        i = end + 1;
+    }
+    if (words.empty()) {
+        return {};
+    }
+
+    std::vector<Hit> hits;
+    auto consider = [&](uint32_t index) {
+        const Doc& doc = _docs[index];
+        uint32_t score = 0;
+        for (auto& w : words) {
+            size_t pos = Find(doc.text, doc.name_len, w);
+            if (pos == std::string::npos) {
+                return;
+            }
+            if (pos == 0) {
+                continue;
+            }
+            if (pos < doc.name_len) {
+                score += IsWordStart(doc.text, pos) ? 1 : 2;
+            } else {
+                score += 3;
+            }
+        }
+        hits.push_back({score, doc.name_len, index});
+    };
+
+    // the shortest posting list among all words' keys bounds the candidates
+    const std::vector<Posting>* candidates = nullptr;
+    bool exact_possible = true;
+    for (auto& w : words) {
+        std::vector<uint32_t> keys = w.size() < 3 ? std::vector<uint32_t>{PrefixKey(w)} : Trigrams(w);
+        for (uint32_t g : keys) {
+            auto it = _postings.find(g);
+            if (it == _postings.end()) {
+                exact_possible = false;
+                break;
+            }
+            if (candidates == nullptr || it->second.size() < candidates->size()) {
+                candidates = &it->second;
+            }
+        }
+    }
+    if (exact_possible) {
+        for (const Posting& p : *candidates) {
+            const Doc& doc = _docs[p.index];
+            if (doc.generation != 0 && doc.stamp == p.stamp) {
+                consider(p.index);
+            }
+        }
+    }
+    if (hits.size() < std::min(max, FUZZY_BELOW)) {
+        fuzzy(words, hits);
+    }
+    size_t count = std::min(max, hits.size());
+    std::partial_sort(hits.begin(), hits.begin() + count, hits.end());
+    std::vector<SoundId> results;
+    results.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        results.push_back({hits[i].index, _docs[hits[i].index].generation});
+    }
+    return results;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SoundId.hpp"
+
+// trigram index over the name, path and tags of every library entry, plus one and two letter
+// prefixes of the words in the name. a query is split on spaces and every word has to appear in the entry,
+// candidates come from the rarest key of the query so most entries are never looked at.
+// when that finds only a handful, entries sharing enough trigrams with every word are checked for a close match,
+// so a typo still finds the sound.
+class SearchIndex {
+    struct Doc {
+        std::string text; // lowercased name, path and tags separated by '\n'
+        uint32_t name_len=0, gram_count=0;
+        uint32_t generation=0; // 0 if the slot isn't indexed
+        uint32_t stamp=0; // changes every time the slot is (re)indexed
+    };
+    struct Posting {
+        uint32_t index, stamp;
+    };
+    // lower is better: matches at the start of the name, then at a word start in the name,
+    // then anywhere in the name, then only in the path or tags, then near misses by how many edits they need
+    struct Hit {
+        uint32_t score, name_len, index;
+        bool operator<(const Hit& other) const {
+            if (score != other.score) return score < other.score;
+            if (name_len != other.name_len) return name_len < other.name_len;
+            return index < other.index;
+        }
+    };
+    static constexpr uint32_t FUZZY_SCORE = 100;
+    // near misses are only looked for while exact matching finds fewer entries than this
+    static constexpr size_t FUZZY_BELOW = 8;
+    std::vector<Doc> _docs; // by SoundId::index
+    // trigram -> entries containing it. removed or reindexed entries are left in place and skipped
+    // by their stamp, the lists are rebuilt once they hold more stale postings than live ones.
+    std::unordered_map<uint32_t, std::vector<Posting>> _postings;
+    size_t _live_postings=0, _stale_postings=0;
+    uint32_t _next_stamp=1;
+    static std::vector<uint32_t> Trigrams(const std::string& text);
+    static std::vector<uint32_t> Keys(const std::string& text, uint32_t name_len);
+    static bool IsWordStart(const std::string& text, size_t pos);
+    static size_t Find(const std::string& text, uint32_t name_len, const std::string& w);
+    static uint32_t PrefixKey(const std::string& word);
+    static std::vector<uint64_t> Masks(const std::string& word);
+    static uint32_t SubstringDistance(const std::vector<uint64_t>& masks, size_t length, const std::string& text, uint32_t name_len, uint32_t limit, uint32_t& in_name);
+    void fuzzy(const std::vector<std::string>& words, std::vector<Hit>& hits) const;
+    void rebuild();
+    public:
+    void add(SoundId id, const std::string& name, const std::string& path, const std::string& tags);
+    void remove(SoundId id);
+    void clear();
+    // best matches first, at most max of them
+    std::vector<SoundId> search(const std::string& query, size_t max) const;
+};
@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../include/nlohmann/json.hpp"
+#include "../thirdparty/raylib-5.0/src/raylib.h"
+#include "AtomicFile.hpp"
+#include "SoundBundle.hpp"
+
+struct BundleHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint64_t index_size;
+    uint64_t data_offset;
+};
+
+static const char BUNDLE_MAGIC[8] = {'S', 'B', 'B', 'U', 'N', 'D', 'L', 'E'};
+
+static uint64_t Align(uint64_t offset) {
+    return (offset + SoundBundle::ALIGNMENT - 1) / SoundBundle::ALIGNMENT * SoundBundle::ALIGNMENT;
+}
+
+static std::mutex mounted_lock;
+static std::map<std::string, std::unique_ptr<SoundBundle>> mounted;
+// mappings of bundles that were written over, open decoders may still point into them
+static std::vector<std::unique_ptr<SoundBundle>> retired;
+
+SoundBundle::~SoundBundle() {
+#ifndef WIN32
+    if (_data != nullptr && _buffer.empty()) {
+        munmap((void*)_data, _size);
+    }
+#endif
+}
+
+bool SoundBundle::map() {
+#ifndef WIN32
+    int fd = open(_filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // the mapping keeps the file open by itself
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    _data = (const unsigned char*)data;
+    _size = st.st_size;
+    return true;
+#else
+    // not mapped on Windows yet, the whole file is read instead
+    std::ifstream fd(_filename, std::ios::binary | std::ios::ate);
+    if (!fd.is_open() || fd.tellg() <= 0) {
+        return false;
+    }
+    _buffer.resize(fd.tellg());
+    fd.seekg(0);
+    if (!fd.read((char*)_buffer.data(), _buffer.size())) {
+        return false;
+    }
+    _data = _buffer.data();
+    _size = _buffer.size();
+    return true;
+#endif
+}
+
+bool SoundBundle::parse() {
+    BundleHeader header;
+    if (_size < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, _data, sizeof(header));
+    if (memcmp(header.magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC)) != 0 || header.version != VERSION) {
+        TraceLog(LOG_WARNING, "Not a sound bundle, or from a newer version: \"%s\"", _filename.c_str());
+        return false;
+    }
+    if (header.index_size > _size - sizeof(header) || header.data_offset < sizeof(header) + header.index_size || header.data_offset > _size) {
+        TraceLog(LOG_WARNING, "Sound bundle is truncated: \"%s\"", _filename.c_str());
+        return false;
+    }
+    const char* index_start = (const char*)_data + sizeof(header);
+    nlohmann::json index;
+    try {
+        index = nlohmann::json::parse(index_start, index_start + header.index_size);
+    } catch (nlohmann::detail::exception err) {
+        TraceLog(LOG_WARNING, "Failed to read the index of sound bundle \"%s\": %s", _filename.c_str(), err.what());
+        return false;
+    }
+    auto sounds = index.find("sounds");
+    if (sounds == index.end() || !sounds->is_array()) {
+        return false;
+    }
+    _entries.reserve(sounds->size());
+    for (auto& s : *sounds) {
+        Entry entry;
+        try {
+            entry.name = s.at("name").get<std::string>();
+            entry.format = s.at("format").get<std::string>();
+            entry.offset = header.data_offset + s.at("offset").get<uint64_t>();
+            entry.length = s.at("length").get<uint64_t>();
+            entry.settings = SoundSettings::FromJson(s.value("config", nlohmann::json::object()));
+            const nlohmann::json& md = s.value("metadata", nlohmann::json::object());
+            entry.metadata.length = md.value("l", 0.0f);
+            entry.metadata.channels = md.value("c", 0u);
+            entry.metadata.sample_rate = md.value("sr", 0u);
+            entry.metadata.sample_size = md.value("ss", 0u);
+        } catch (nlohmann::detail::exception err) {
+            TraceLog(LOG_WARNING, "Skipped a broken entry in sound bundle \"%s\": %s", _filename.c_str(), err.what());
+            continue;
+        }
+        if (entry.name.empty() || entry.name.find(SEPARATOR) != std::string::npos || _by_name.count(entry.name) > 0
+            || entry.offset > _size || entry.length > _size - entry.offset || entry.length > INT_MAX) {
+            TraceLog(LOG_WARNING, "Skipped a broken entry in sound bundle \"%s\": \"%s\"", _filename.c_str(), entry.name.c_str());
+            continue;
+        }
+        _by_name[entry.name] = _entries.size();
+        _entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+SoundBundle* SoundBundle::Mount(const std::string& filename) {
+    std::lock_guard<std::mutex> guard(mounted_lock);
+    auto it = mounted.find(filename);
+    if (it != mounted.end()) {
+        return it->second.get();
+    }
+    std::unique_ptr<SoundBundle> bundle(new SoundBundle(filename));
+    if (!bundle->map() || !bundle->parse()) {
+        TraceLog(LOG_WARNING, "Failed to open sound bundle \"%s\"", filename.c_str());
+        return nullptr;
+    }
+    TraceLog(LOG_INFO, "Opened sound bundle \"%s\" with %d sounds.", filename.c_str(), (int)bundle->_entries.size());
+    return (mounted[filename] = std::move(bundle)).get();
+}
+
+bool SoundBundle::IsBundle(const std::string& filename) {
+    return filename.size() > strlen(EXTENSION) && filename.compare(filename.size() - strlen(EXTENSION), std::string::npos, EXTENSION) == 0;
+}
+
+std::string SoundBundle::MemberPath(const std::string& bundle, const std::string& name) {
+    return bundle + SEPARATOR + name;
+}
+
+bool SoundBundle::SplitMemberPath(const std::string& path, std::string& bundle, std::string& name) {
+    size_t sep = path.rfind(SEPARATOR);
+    if (sep == std::string::npos || !IsBundle(path.substr(0, sep))) {
+        return false;
+    }
+    bundle = path.substr(0, sep);
+    name = path.substr(sep + strlen(SEPARATOR));
+    return true;
+}
+
+bool SoundBundle::Locate(const std::string& path, SoundBundle*& bundle, const Entry*& entry) {
+    std::string bundle_path, name;
+    if (!SplitMemberPath(path, bundle_path, name) || (bundle = Mount(bundle_path)) == nullptr) {
+        return false;
+    }
+    entry = bundle->find(name);
+    return entry != nullptr;
+}
+
+const SoundBundle::Entry* SoundBundle::find(const std::string& name) const {
+    auto it = _by_name.find(name);
+    return it == _by_name.end() ? nullptr : &_entries[it->second];
+}
+
+int SoundBundle::Write(const std::string& filename, const std::vector<Source>& sources) {
+    struct Blob {
+        std::string name, format, file;
+        const unsigned char* data=nullptr; // set for sounds that come from another bundle
+        uint64_t offset, length;
+        const Source* source;
+    };
+    std::vector<Blob> blobs;
+    std::unordered_map<std::string, int> names;
+    uint64_t offset = 0;
+    nlohmann::json index_sounds = nlohmann::json::array();
+    for (const Source& s : sources) {
+        Blob blob;
+        blob.source = &s;
+        std::string name;
+        SoundBundle* bundle;
+        const Entry* entry;
+        if (Locate(s.path, bundle, entry)) {
+            blob.data = bundle->data(*entry);
+            blob.length = entry->length;
+            name = entry->name;
+        } else {
+            std::error_code ec;
+            blob.length = std::filesystem::file_size(s.path, ec);
+            if (ec || blob.length == 0 || blob.length > INT_MAX) {
+                TraceLog(LOG_WARNING, "Left out of the bundle, can't read it: \"%s\"", s.path.c_str());
+                continue;
+            }
+            blob.file = s.path;
+            name = std::filesystem::path(s.path).filename().string();
+        }
+        // files with the same name from different folders
+        std::string stem = std::filesystem::path(name).stem().string(), extension = std::filesystem::path(name).extension().string();
+        blob.name = name;
+        for (int n = 2; names.count(blob.name) > 0; n++) {
+            blob.name = stem + " (" + std::to_string(n) + ")" + extension;
+        }
+        names[blob.name] = 1;
+        blob.format = extension;
+        std::transform(blob.format.begin(), blob.format.end(), blob.format.begin(), [] (unsigned char c) { return tolower(c); });
+        blob.offset = Align(offset);
+        offset = blob.offset + blob.length;
+        nlohmann::json sound = {
+            {"name", blob.name},
+            {"format", blob.format},
+            {"offset", blob.offset},
+            {"length", blob.length},
+            {"config", s.settings.toJson()},
+        };
+        if (s.metadata.valid()) {
+            sound["metadata"] = {
+                {"l", s.metadata.length},
+                {"c", s.metadata.channels},
+                {"sr", s.metadata.sample_rate},
+                {"ss", s.metadata.sample_size},
+            };
+        }
+        index_sounds.push_back(std::move(sound));
+        blobs.push_back(std::move(blob));
+    }
+    std::string index = nlohmann::json({{"sounds", std::move(index_sounds)}}).dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore);
+    BundleHeader header;
+    memcpy(header.magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC));
+    header.version = VERSION;
+    header.count = blobs.size();
+    header.index_size = index.size();
+    header.data_offset = Align(sizeof(header) + index.size());
+
+    bool written = WriteFileAtomic(filename, [&] (FILE* fd) {
+        static const char zeros[ALIGNMENT] = {0};
+        uint64_t position = 0;
+        auto put = [&] (const void* data, size_t size) {
+            position += size;
+            return fwrite(data, 1, size, fd) == size;
+        };
+        auto pad = [&] (uint64_t to) {
+            return put(zeros, to - position);
+        };
+        if (!put(&header, sizeof(header)) || !put(index.data(), index.size())) {
+            return false;
+        }
+        std::vector<char> chunk(1 << 20);
+        for (const Blob& blob : blobs) {
+            if (!pad(header.data_offset + blob.offset)) {
+                return false;
+            }
+            if (blob.data != nullptr) {
+                if (!put(blob.data, blob.length)) {
+                    return false;
+                }
+                continue;
+            }
+            std::ifstream in(blob.file, std::ios::binary);
+            uint64_t left = blob.length;
+            while (left > 0 && in.read(chunk.data(), std::min<uint64_t>(left, chunk.size()))) {
+                if (!put(chunk.data(), in.gcount())) {
+                    return false;
+                }
+                left -= in.gcount();
+            }
+            if (left > 0) {
+                TraceLog(LOG_WARNING, "Failed to read \"%s\" while writing the bundle", blob.file.c_str());
+                return false;
+            }
+        }
+        return true;
+    });
+    if (!written) {
+        TraceLog(LOG_ERROR, "Failed to write sound bundle \"%s\"", filename.c_str());
+        return -1;
+    }
+    // a mount of the old file would keep serving its index, the next lookup mounts the new one
+    std::lock_guard<std::mutex> guard(mounted_lock);
+    auto it = mounted.find(filename);
+    if (it != mounted.end()) {
+        retired.push_back(std::move(it->second));
+        mounted.erase(it);
+    }
+    return blobs.size();
+}
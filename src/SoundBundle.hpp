@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MetadataCache.hpp"
+#include "SoundSettings.hpp"
+
+// a board packed into one file to move it between machines:
+//   header   "SBBUNDLE", u32 version, u32 sound count, u64 index size, u64 data offset
+//   index    json, {"sounds": [{"name", "format", "offset", "length", "config", "metadata"}, ...]}
+//   data     the sound files as they were, each starting on an ALIGNMENT boundary, index offsets count from the data offset
+// a bundle is mapped once and its sounds are decoded straight from the mapping, they are listed as
+// "<bundle path>::<name>". the mapping stays until exit since open decoders point into it, writing over a
+// mounted bundle retires its mapping and the next lookup mounts the new file.
+class SoundBundle {
+    public:
+    static constexpr const char* EXTENSION = ".sbundle";
+    static constexpr const char* SEPARATOR = "::";
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint64_t ALIGNMENT = 4096;
+    struct Entry {
+        std::string name;
+        std::string format; // lowercase extension with the dot, as LoadMusicStreamFromMemory wants it
+        uint64_t offset, length; // offset from the start of the file
+        SoundSettings settings;
+        SoundMetadata metadata;
+    };
+    // a sound to pack, path is a file or a member of a mounted bundle
+    struct Source {
+        std::string path;
+        SoundSettings settings;
+        SoundMetadata metadata;
+    };
+    private:
+    std::string _filename;
+    const unsigned char* _data=nullptr;
+    size_t _size=0;
+    std::vector<unsigned char> _buffer; // holds the file where it isn't mapped
+    std::vector<Entry> _entries;
+    std::unordered_map<std::string, size_t> _by_name;
+    bool map();
+    bool parse();
+    SoundBundle(const std::string& filename) : _filename(filename) {}
+    public:
+    SoundBundle(const SoundBundle&) = delete;
+    ~SoundBundle();
+    // maps the bundle the first time it is asked for, nullptr if it can't be read. safe from any thread
+    static SoundBundle* Mount(const std::string& filename);
+    static bool IsBundle(const std::string& filename);
+    static std::string MemberPath(const std::string& bundle, const std::string& name);
+    // false for paths that don't point into a bundle
+    static bool SplitMemberPath(const std::string& path, std::string& bundle, std::string& name);
+    // finds the entry a member path points to, mounting its bundle
+    static bool Locate(const std::string& path, SoundBundle*& bundle, const Entry*& entry);
+    // packs the sounds, returns how many were written or -1 if the bundle couldn't be written
+    static int Write(const std::string& filename, const std::vector<Source>& sources);
+    const std::string& filename() const {
+        return _filename;
+    }
+    const std::vector<Entry>& entries() const {
+        return _entries;
+    }
+    const Entry* find(const std::string& name) const;
+    const unsigned char* data(const Entry& entry) const {
+        return _data + entry.offset;
+    }
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+// handle to a library entry. stays valid across sorting and shuffling,
+// and stops resolving once the entry is removed even if its slot is reused.
+struct SoundId {
+    uint32_t index=0, generation=0;
+    bool valid() const {
+        return generation != 0;
+    }
+    bool operator==(const SoundId& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const SoundId& other) const {
+        return !(*this == other);
+    }
+};
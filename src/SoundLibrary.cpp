@@ -0,0 +1,164 @@
+#include <algorithm>
+
+#include "SoundLibrary.hpp"
+
+static const std::string empty_path;
+
+SoundId SoundLibrary::add(const std::string& path, ConfiguredMusic* music) {
+    if (music == nullptr || _by_path.count(path) > 0) {
+        return SoundId();
+    }
+    uint32_t index;
+    if (_free.size() > 0) {
+        index = _free.back();
+        _free.pop_back();
+    } else {
+        index = _slots.size();
+        _slots.emplace_back();
+    }
+    Slot& slot = _slots[index];
+    SoundId id = {index, slot.generation};
+    auto it = _by_path.emplace(path, id).first;
+    slot.music = music;
+    slot.path = &it->first;
+    slot.position = _order.size();
+    _order.push_back(id);
+    _index.add(id, music->name, path, music->tags);
+    _revision++;
+    return id;
+}
+
+bool SoundLibrary::remove(SoundId id) {
+    ConfiguredMusic* music = release(id);
+    if (music == nullptr) {
+        return false;
+    }
+    music->Unload();
+    delete music;
+    return true;
+}
+
+ConfiguredMusic* SoundLibrary::release(SoundId id) {
+    ConfiguredMusic* music = get(id);
+    if (music == nullptr) {
+        return nullptr;
+    }
+    Slot& slot = _slots[id.index];
+    _index.remove(id);
+    _revision++;
+    _by_path.erase(*slot.path);
+    slot.music = nullptr;
+    slot.path = nullptr;
+    // generation 0 is reserved for invalid ids
+    if (++slot.generation == 0) {
+        slot.generation = 1;
+    }
+    _free.push_back(id.index);
+    _stale++;
+    return music;
+}
+
+void SoundLibrary::clear() {
+    for (auto& slot : _slots) {
+        if (slot.music != nullptr) {
+            slot.music->Unload();
+            delete slot.music;
+            slot.music = nullptr;
+            slot.path = nullptr;
+            if (++slot.generation == 0) {
+                slot.generation = 1;
+            }
+        }
+    }
+    _free.clear();
+    for (uint32_t i = _slots.size(); i > 0; i--) {
+        _free.push_back(i - 1);
+    }
+    _by_path.clear();
+    _order.clear();
+    _stale = 0;
+    _index.clear();
+    _revision++;
+}
+
+ConfiguredMusic* SoundLibrary::get(SoundId id) const {
+    if (!id.valid() || id.index >= _slots.size() || _slots[id.index].generation != id.generation) {
+        return nullptr;
+    }
+    return _slots[id.index].music;
+}
+
+SoundId SoundLibrary::find(const std::string& path) const {
+    auto it = _by_path.find(path);
+    if (it == _by_path.end()) {
+        return SoundId();
+    }
+    return it->second;
+}
+
+SoundId SoundLibrary::findByName(const std::string& name) const {
+    for (auto& slot : _slots) {
+        if (slot.music == nullptr) {
+            continue;
+        }
+        const std::string& n = slot.music->name;
+        size_t dot = n.rfind('.');
+        if (n == name || (dot != std::string::npos && n.compare(0, dot, name) == 0 && dot == name.size())) {
+            return {(uint32_t)(&slot - _slots.data()), slot.generation};
+        }
+    }
+    return SoundId();
+}
+
+const std::string& SoundLibrary::pathOf(SoundId id) const {
+    if (get(id) == nullptr) {
+        return empty_path;
+    }
+    return *_slots[id.index].path;
+}
+
+void SoundLibrary::compact() {
+    if (_stale == 0) {
+        return;
+    }
+    size_t n = 0;
+    for (size_t i = 0; i < _order.size(); i++) {
+        if (get(_order[i]) != nullptr) {
+            _slots[_order[i].index].position = n;
+            _order[n++] = _order[i];
+        }
+    }
+    _order.resize(n);
+    _stale = 0;
+}
+
+const std::vector<SoundId>& SoundLibrary::order() {
+    compact();
+    return _order;
+}
+
+SoundId SoundLibrary::next(SoundId id) {
+    compact();
+    if (_order.empty()) {
+        return SoundId();
+    }
+    if (get(id) == nullptr) {
+        return _order.front();
+    }
+    return _order[(_slots[id.index].position + 1) % _order.size()];
+}
+
+void SoundLibrary::reindex(SoundId id) {
+    if (ConfiguredMusic* music = get(id)) {
+        _index.add(id, music->name, *_slots[id.index].path, music->tags);
+        _revision++;
+    }
+}
+
+void SoundLibrary::shuffle(std::mt19937& rng) {
+    compact();
+    std::shuffle(_order.begin(), _order.end(), rng);
+    for (uint32_t i = 0; i < _order.size(); i++) {
+        _slots[_order[i].index].position = i;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ConfiguredMusic.hpp"
+#include "SearchIndex.hpp"
+#include "SoundId.hpp"
+
+// owns the loaded sounds. entries live in reusable slots addressed by SoundId,
+// paths are interned once in a hash index, and the display order is a separate list of ids.
+class SoundLibrary {
+    struct Slot {
+        ConfiguredMusic* music=nullptr;
+        const std::string* path=nullptr; // key in _by_path
+        uint32_t generation=1;
+        uint32_t position=0; // index into _order
+    };
+    std::vector<Slot> _slots;
+    std::vector<uint32_t> _free;
+    std::unordered_map<std::string, SoundId> _by_path;
+    std::vector<SoundId> _order;
+    size_t _stale=0; // removed ids still in _order
+    SearchIndex _index;
+    uint32_t _revision=0;
+    public:
+    // takes ownership of music, returns an invalid id if the path is already listed
+    SoundId add(const std::string& path, ConfiguredMusic* music);
+    // unloads and deletes the entry, returns false if the id no longer resolves
+    bool remove(SoundId id);
+    // takes the entry out without unloading it, the caller owns the returned music
+    ConfiguredMusic* release(SoundId id);
+    void clear();
+    ConfiguredMusic* get(SoundId id) const;
+    SoundId find(const std::string& path) const;
+    // an entry named name, with or without its extension. walks every entry
+    SoundId findByName(const std::string& name) const;
+    bool contains(const std::string& path) const {
+        return _by_path.count(path) > 0;
+    }
+    const std::string& pathOf(SoundId id) const;
+    size_t size() const {
+        return _by_path.size();
+    }
+    // ids in display order, removed entries are skipped
+    const std::vector<SoundId>& order();
+    // drops removed ids from the display order. done before the engine lock is released after removing,
+    // so order() only reads the list on the threads that share it
+    void compact();
+    // the entry after id in display order, wrapping around; invalid if the library is empty
+    SoundId next(SoundId id);
+    // reorders the display list, less receives two ids that are both valid
+    template<class Less>
+    void sort(Less less) {
+        compact();
+        std::stable_sort(_order.begin(), _order.end(), less);
+        for (uint32_t i = 0; i < _order.size(); i++) {
+            _slots[_order[i].index].position = i;
+        }
+    }
+    void shuffle(std::mt19937& rng);
+    // updates the search index after the entry's name or tags changed
+    void reindex(SoundId id);
+    std::vector<SoundId> search(const std::string& query, size_t max) const {
+        return _index.search(query, max);
+    }
+    // changes whenever entries are added, removed or reindexed
+    uint32_t revision() const {
+        return _revision;
+    }
+};
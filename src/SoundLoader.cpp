@@ -0,0 +1,141 @@
+#include <algorithm>
+
+#include "SoundLoader.hpp"
+
+SoundLoader::SoundLoader(unsigned int threads) {
+    if (threads == 0) {
+        threads = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+    }
+    for (unsigned int i = 0; i < threads; i++) {
+        _workers.emplace_back(&SoundLoader::work, this);
+    }
+}
+
+SoundLoader::~SoundLoader() {
+    stop();
+    std::lock_guard<std::mutex> guard(_results_lock);
+    for (auto& r : _results) {
+        delete r.music;
+    }
+    _results.clear();
+}
+
+void SoundLoader::work() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> guard(_jobs_lock);
+            _jobs_cv.wait(guard, [this] { return _stopping || !_jobs.empty(); });
+            if (_stopping) {
+                return;
+            }
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+        if (job.id.valid()) {
+            Opened opened = {job.id, job.path, Music(), 0};
+            if (!ConfiguredMusic::Open(job.path, opened.music, job.preload, job.metadata, opened.preloaded_bytes)) {
+                opened.music = Music();
+            }
+            _on_opened(opened);
+            _opening--;
+            continue;
+        }
+        Result result = {job.path, nullptr};
+        SoundMetadata md;
+        if (ConfiguredMusic::Probe(job.path, md)) {
+            result.music = ConfiguredMusic::LoadLazy(job.path, job.settings, md);
+        }
+        {
+            std::lock_guard<std::mutex> guard(_results_lock);
+            _results.push_back(result);
+        }
+        _completed++;
+    }
+}
+
+void SoundLoader::enqueue(const std::string& path, const SoundSettings& settings) {
+    {
+        std::lock_guard<std::mutex> guard(_jobs_lock);
+        if (_stopping) {
+            return;
+        }
+        // nothing in flight, start a new progress count
+        if (_completed == _total) {
+            _completed = 0;
+            _total = 0;
+        }
+        // counted before a worker can see the job, or it could complete first
+        _total++;
+        _jobs.push_back({path, settings, SoundId(), false, SoundMetadata()});
+    }
+    _jobs_cv.notify_one();
+}
+
+void SoundLoader::open(SoundId id, const std::string& path, bool preload, const SoundMetadata& metadata) {
+    {
+        std::lock_guard<std::mutex> guard(_jobs_lock);
+        if (_stopping) {
+            return;
+        }
+        _opening++;
+        Job job = {path, SoundSettings(), id, preload, metadata};
+        _jobs.push_front(std::move(job));
+    }
+    _jobs_cv.notify_one();
+}
+
+size_t SoundLoader::drain(std::vector<Result>& out, size_t max) {
+    std::lock_guard<std::mutex> guard(_results_lock);
+    size_t count = std::min(max, _results.size());
+    out.insert(out.end(), _results.begin(), _results.begin() + count);
+    _results.erase(_results.begin(), _results.begin() + count);
+    return count;
+}
+
+void SoundLoader::cancel() {
+    std::lock_guard<std::mutex> guard(_jobs_lock);
+    auto probes = std::remove_if(_jobs.begin(), _jobs.end(), [] (const Job& job) {
+        return !job.id.valid();
+    });
+    _total -= (unsigned int)(_jobs.end() - probes);
+    _jobs.erase(probes, _jobs.end());
+}
+
+void SoundLoader::stop() {
+    {
+        std::lock_guard<std::mutex> guard(_jobs_lock);
+        _stopping = true;
+        for (const Job& job : _jobs) {
+            if (job.id.valid()) {
+                _opening--;
+            } else {
+                _total--;
+            }
+        }
+        _jobs.clear();
+    }
+    _jobs_cv.notify_all();
+    for (auto& t : _workers) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+    _workers.clear();
+}
+
+bool SoundLoader::isBusy() {
+    if (_completed < _total || _opening > 0) {
+        return true;
+    }
+    std::lock_guard<std::mutex> guard(_results_lock);
+    return !_results.empty();
+}
+
+unsigned int SoundLoader::total() {
+    return _total;
+}
+
+unsigned int SoundLoader::completed() {
+    return _completed;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ConfiguredMusic.hpp"
+#include "SoundId.hpp"
+
+// probes sound files on a pool of worker threads.
+// finished entries are handed back to the UI thread in batches through drain(),
+// they come back with their metadata filled in and their decoder closed.
+// open() opens the decoder of a listed entry instead, the stream goes to the onOpened() callback.
+class SoundLoader {
+    public:
+    struct Result {
+        std::string path;
+        ConfiguredMusic* music; // nullptr if the file could not be opened
+    };
+    struct Opened {
+        SoundId id;
+        std::string path;
+        Music music; // not ready if the file could not be opened
+        size_t preloaded_bytes;
+    };
+    private:
+    struct Job {
+        std::string path;
+        SoundSettings settings;
+        SoundId id; // valid for open() jobs
+        bool preload=false;
+        SoundMetadata metadata;
+    };
+    std::vector<std::thread> _workers;
+    std::deque<Job> _jobs;
+    std::vector<Result> _results;
+    std::mutex _jobs_lock, _results_lock;
+    std::condition_variable _jobs_cv;
+    std::atomic<unsigned int> _total{0}, _completed{0};
+    std::atomic<unsigned int> _opening{0}; // open() jobs, not part of the progress count
+    std::function<void(Opened&)> _on_opened;
+    bool _stopping=false;
+    void work();
+    public:
+    SoundLoader(unsigned int threads=0);
+    ~SoundLoader();
+    void enqueue(const std::string& path, const SoundSettings& settings);
+    // opens the entry's decoder ahead of the probes, preloading short clips when asked to
+    void open(SoundId id, const std::string& path, bool preload, const SoundMetadata& metadata);
+    // called on a worker thread with every finished open(), the callee owns the stream. set before any open()
+    void onOpened(std::function<void(Opened&)> callback) {
+        _on_opened = callback;
+    }
+    // moves up to max finished results into out, returns how many were moved
+    size_t drain(std::vector<Result>& out, size_t max);
+    // drops every probe that hasn't started yet, opens still run
+    void cancel();
+    // cancels and joins the workers, must be called before the audio device is closed
+    void stop();
+    // true until every job is done and its result drained
+    bool isBusy();
+    unsigned int total();
+    unsigned int completed();
+};
@@ -0,0 +1,94 @@
+#include "SoundSettings.hpp"
+
+SoundSettings SoundSettings::FromJson(const nlohmann::json& cfg) {
+    SoundSettings s;
+    if (!cfg.is_object()) {
+        return s;
+    }
+    for (auto& [key, value] : cfg.get_ref<const nlohmann::json::object_t&>()) {
+        if (key == "v" && value.is_number()) {
+            s.volume = value.get<float>();
+            s.present |= Volume;
+        } else if (key == "s" && value.is_number()) {
+            s.pitch = value.get<float>();
+            s.present |= Pitch;
+        } else if (key == "p" && value.is_number()) {
+            s.pan = value.get<float>();
+            s.present |= Pan;
+        } else if (key == "r" && value.is_boolean()) {
+            s.repeating = value.get<bool>();
+            s.present |= Repeating;
+        } else if (key == "a" && value.is_boolean()) {
+            s.show_advanced = value.get<bool>();
+            s.present |= ShowAdvanced;
+        } else if (key == "st" && value.is_number()) {
+            s.start_time = value.get<float>();
+            s.present |= StartTime;
+        } else if (key == "et" && value.is_number()) {
+            s.end_time = value.get<float>();
+            s.present |= EndTime;
+        } else if (key == "da" && value.is_number()) {
+            s.date_added = value.get<int64_t>();
+            s.present |= DateAdded;
+        } else if (key == "pc" && value.is_number()) {
+            s.play_count = value.get<unsigned int>();
+            s.present |= PlayCount;
+        } else if (key == "tg" && value.is_string()) {
+            s.tags = value.get_ref<const std::string&>();
+            s.present |= Tags;
+        }
+    }
+    return s;
+}
+
+nlohmann::json SoundSettings::toJson() const {
+    nlohmann::json cfg = nlohmann::json::object();
+    if (has(Volume)) {
+        cfg["v"] = volume;
+    }
+    if (has(Pitch)) {
+        cfg["s"] = pitch;
+    }
+    if (has(Pan)) {
+        cfg["p"] = pan;
+    }
+    if (has(Repeating)) {
+        cfg["r"] = repeating;
+    }
+    if (has(ShowAdvanced)) {
+        cfg["a"] = show_advanced;
+    }
+    if (has(StartTime)) {
+        cfg["st"] = start_time;
+    }
+    if (has(EndTime)) {
+        cfg["et"] = end_time;
+    }
+    if (has(DateAdded)) {
+        cfg["da"] = date_added;
+    }
+    if (has(PlayCount)) {
+        cfg["pc"] = play_count;
+    }
+    if (has(Tags)) {
+        cfg["tg"] = tags;
+    }
+    return cfg;
+}
+
+void SoundSettingsStore::load(const nlohmann::json& sound_configs) {
+    _settings.clear();
+    if (!sound_configs.is_object()) {
+        return;
+    }
+    _settings.reserve(sound_configs.size());
+    for (auto& [path, cfg] : sound_configs.get_ref<const nlohmann::json::object_t&>()) {
+        _settings.emplace(path, SoundSettings::FromJson(cfg));
+    }
+}
+
+const SoundSettings& SoundSettingsStore::get(const std::string& path) const {
+    static const SoundSettings none;
+    auto it = _settings.find(path);
+    return it == _settings.end() ? none : it->second;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "../include/nlohmann/json.hpp"
+
+// what config.json keeps per sound under "sound_configs". json is only read when the config is loaded
+// and written when it is saved, everything in between passes these around instead.
+struct SoundSettings {
+    enum Field : uint16_t {
+        Volume = 1 << 0,
+        Pitch = 1 << 1,
+        Pan = 1 << 2,
+        Repeating = 1 << 3,
+        ShowAdvanced = 1 << 4,
+        StartTime = 1 << 5,
+        EndTime = 1 << 6,
+        DateAdded = 1 << 7,
+        PlayCount = 1 << 8,
+        Tags = 1 << 9,
+        All = (1 << 10) - 1,
+    };
+    uint16_t present=0; // fields that were in the config, the sound keeps its own values for the rest
+    float volume=1.0f, pitch=1.0f, pan=0.5f;
+    float start_time=0.0f, end_time=0.0f;
+    int64_t date_added=0;
+    unsigned int play_count=0;
+    bool repeating=false, show_advanced=false;
+    std::string tags;
+    bool has(Field field) const {
+        return present & field;
+    }
+    static SoundSettings FromJson(const nlohmann::json& cfg);
+    nlohmann::json toJson() const;
+};
+
+// settings by path, filled from "sound_configs" at startup so sounds added later get theirs back
+class SoundSettingsStore {
+    std::unordered_map<std::string, SoundSettings> _settings;
+    public:
+    void load(const nlohmann::json& sound_configs);
+    // settings with nothing present for a path that has none
+    const SoundSettings& get(const std::string& path) const;
+    size_t size() const {
+        return _settings.size();
+    }
+};
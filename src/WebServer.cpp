@@ -0,0 +1,608 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "../include/nlohmann/json.hpp"
+#include "WebServer.hpp"
+
+WebServer::~WebServer() {
+    stop();
+}
+
+#ifdef __linux__
+static const char* pad_page = R"html(<!doctype html>
+<html><head><meta charset="utf-8"><meta name="viewport" content="width=device-width">
+<title>Beck's Soundboard</title>
+<style>
+body { background: #111; color: #ddd; font-family: sans-serif; margin: 0; }
+#bar { position: sticky; top: 0; background: #222; padding: 8px; display: flex; gap: 8px; align-items: center; }
+#name { flex: 1; overflow: hidden; white-space: nowrap; }
+#pads { display: grid; grid-template-columns: repeat(auto-fill, minmax(140px, 1fr)); gap: 6px; padding: 8px; }
+.pad { height: 64px; background: #2a3a55; color: #fff; border: 0; border-radius: 6px; overflow: hidden; }
+.pad.current { background: #3d6b3d; }
+</style></head><body>
+<div id="bar">
+<button id="stop">Stop</button><span id="name"></span>
+<progress id="position" max="1" value="0"></progress>
+<meter id="level" min="0" max="1" low="0.7" high="0.9" value="0"></meter>
+<label>Master <input id="master" type="range" min="0" max="1" step="0.01"></label>
+<span id="status">Connecting...</span>
+</div>
+<div id="pads"></div>
+<script>
+const $ = id => document.getElementById(id);
+let ws, pads = {}, current = null;
+function highlight(id) {
+    if (pads[current]) pads[current].classList.remove("current");
+    current = id;
+    if (pads[current]) pads[current].classList.add("current");
+    $("name").textContent = pads[current] ? pads[current].textContent : "";
+}
+function connect() {
+    ws = new WebSocket("ws://" + location.host + "/ws");
+    ws.onopen = () => $("status").textContent = "";
+    ws.onclose = () => { $("status").textContent = "Disconnected"; setTimeout(connect, 1000); };
+    ws.onmessage = e => {
+        const m = JSON.parse(e.data);
+        if (m.library) {
+            pads = {};
+            $("pads").textContent = "";
+            for (const s of m.library) {
+                const pad = document.createElement("button");
+                pad.className = "pad";
+                pad.textContent = s.name;
+                pad.onclick = () => ws.send("play " + s.id);
+                $("pads").appendChild(pad);
+                pads[s.id] = pad;
+            }
+            highlight(current);
+            return;
+        }
+        if (m.current !== current) highlight(m.current);
+        $("position").value = m.length > 0 ? m.position / m.length : 0;
+        $("level").value = m.level;
+        if (document.activeElement !== $("master")) $("master").value = m.master;
+    };
+}
+$("stop").onclick = () => ws.send("stop");
+$("master").oninput = () => ws.send("master " + $("master").value);
+connect();
+</script></body></html>
+)html";
+
+static uint32_t Rotl(uint32_t v, int n) {
+    return (v << n) | (v >> (32 - n));
+}
+
+// only used for the WebSocket handshake
+static std::string Sha1(const std::string& message) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    std::string m = message;
+    uint64_t bits = (uint64_t)message.size() * 8;
+    m += (char)0x80;
+    while (m.size() % 64 != 56) {
+        m += (char)0;
+    }
+    for (int i = 7; i >= 0; i--) {
+        m += (char)(bits >> (i * 8));
+    }
+    for (size_t chunk = 0; chunk < m.size(); chunk += 64) {
+        const unsigned char* p = (const unsigned char*)m.data() + chunk;
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            w[i] = ((uint32_t)p[i * 4] << 24) | ((uint32_t)p[i * 4 + 1] << 16) | ((uint32_t)p[i * 4 + 2] << 8) | p[i * 4 + 3];
+        }
+        for (int i = 16; i < 80; i++) {
+            w[i] = Rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t t = Rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = Rotl(b, 30);
+            b = a;
+            a = t;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+    std::string digest;
+    for (uint32_t v : h) {
+        for (int i = 3; i >= 0; i--) {
+            digest += (char)(v >> (i * 8));
+        }
+    }
+    return digest;
+}
+
+static std::string Base64(const std::string& data) {
+    static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < data.size(); i += 3) {
+        uint32_t v = (uint32_t)(unsigned char)data[i] << 16;
+        if (i + 1 < data.size()) v |= (uint32_t)(unsigned char)data[i + 1] << 8;
+        if (i + 2 < data.size()) v |= (unsigned char)data[i + 2];
+        out += alphabet[(v >> 18) & 63];
+        out += alphabet[(v >> 12) & 63];
+        out += i + 1 < data.size() ? alphabet[(v >> 6) & 63] : '=';
+        out += i + 2 < data.size() ? alphabet[v & 63] : '=';
+    }
+    return out;
+}
+
+// a complete unmasked text frame
+static std::string Frame(const std::string& payload, unsigned char opcode = 0x1) {
+    std::string frame(1, (char)(0x80 | opcode));
+    size_t n = payload.size();
+    if (n < 126) {
+        frame += (char)n;
+    } else if (n < 65536) {
+        frame += (char)126;
+        frame += (char)(n >> 8);
+        frame += (char)n;
+    } else {
+        frame += (char)127;
+        for (int i = 7; i >= 0; i--) {
+            frame += (char)((uint64_t)n >> (i * 8));
+        }
+    }
+    return frame + payload;
+}
+
+static std::string IdString(SoundId id) {
+    return std::to_string(id.index) + "." + std::to_string(id.generation);
+}
+
+static std::string StateFrame(const AudioEngine::Snapshot& s) {
+    nlohmann::json state = {
+        {"current", s.current.valid() ? nlohmann::json(IdString(s.current)) : nlohmann::json(nullptr)},
+        {"playing", s.playing},
+        {"position", s.position},
+        {"length", s.length},
+        {"level", s.level},
+        {"master", s.master_volume},
+    };
+    return Frame(state.dump());
+}
+
+// small moves of the position and level aren't worth a message
+static bool Changed(const AudioEngine::Snapshot& a, const AudioEngine::Snapshot& b) {
+    return a.current != b.current || a.playing != b.playing || a.length != b.length || a.master_volume != b.master_volume
+        || std::fabs(a.position - b.position) >= 0.05f || std::fabs(a.level - b.level) >= 0.01f;
+}
+
+static std::string Response(const char* status, const char* type, const std::string& body) {
+    char head[256];
+    snprintf(head, sizeof(head), "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %d\r\nCache-Control: no-store\r\nConnection: close\r\n\r\n",
+        status, type, (int)body.size());
+    return head + body;
+}
+
+bool WebServer::start(int port) {
+    stop();
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    _listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int reuse = 1;
+    setsockopt(_listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (port < 0 || port > 65535 || bind(_listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(_listen_fd, 64) < 0) {
+        TraceLog(LOG_ERROR, "Web server: can't listen on port %d, %s", port, strerror(errno));
+        stop();
+        return false;
+    }
+    socklen_t length = sizeof(addr);
+    getsockname(_listen_fd, (sockaddr*)&addr, &length);
+    _port = ntohs(addr.sin_port);
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    _wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    for (int fd : {_listen_fd, _wake_fd}) {
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+    _library_frame.clear();
+    _pushed = AudioEngine::Snapshot();
+    _stopping = false;
+    _thread = std::thread(&WebServer::work, this);
+    TraceLog(LOG_INFO, "Web server: pad page at http://127.0.0.1:%d/", (int)_port);
+    return true;
+}
+
+void WebServer::stop() {
+    _stopping = true;
+    if (_wake_fd >= 0) {
+        uint64_t one = 1;
+        (void)!write(_wake_fd, &one, sizeof(one));
+    }
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    for (auto& c : _clients) {
+        close(c.first);
+    }
+    _clients.clear();
+    for (int* fd : {&_listen_fd, &_epoll_fd, &_wake_fd}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+    _port = 0;
+}
+
+void WebServer::work() {
+    epoll_event events[64];
+    Clock::time_point last_push, last_library_push;
+    while (!_stopping) {
+        bool pages_open = false;
+        for (auto& c : _clients) {
+            pages_open |= c.second.websocket;
+        }
+        // without an open page nothing is pushed and the thread only wakes up for connections
+        int timeout = -1;
+        if (pages_open) {
+            auto due = last_push + PUSH_PERIOD - Clock::now();
+            timeout = std::max(0, (int)std::chrono::duration_cast<std::chrono::milliseconds>(due).count());
+        }
+        int n = epoll_wait(_epoll_fd, events, 64, timeout);
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == _wake_fd) {
+                uint64_t count;
+                (void)!read(_wake_fd, &count, sizeof(count));
+            } else if (fd == _listen_fd) {
+                accept();
+            } else if (_clients.count(fd) > 0) {
+                Client& client = _clients[fd];
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    receive(fd, client);
+                }
+                if (events[i].events & EPOLLOUT) {
+                    flush(fd, client);
+                }
+            }
+        }
+        Clock::time_point now = Clock::now();
+        if (pages_open && now - last_push >= PUSH_PERIOD) {
+            bool library_due = now - last_library_push >= LIBRARY_PUSH_PERIOD;
+            push(library_due);
+            last_push = now;
+            if (library_due) {
+                last_library_push = now;
+            }
+        }
+        for (auto it = _clients.begin(); it != _clients.end();) {
+            int fd = it->first;
+            it++;
+            if (_clients[fd].closing && _clients[fd].out.empty()) {
+                drop(fd);
+            }
+        }
+    }
+}
+
+void WebServer::accept() {
+    int fd;
+    while ((fd = ::accept4(_listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        if (_clients.size() >= MAX_CLIENTS) {
+            close(fd);
+            continue;
+        }
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+        _clients[fd];
+    }
+}
+
+void WebServer::drop(int fd) {
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    _clients.erase(fd);
+}
+
+void WebServer::receive(int fd, Client& client) {
+    char buf[4096];
+    while (true) {
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            client.closing = true;
+            client.out.clear();
+            return;
+        }
+        if (n < 0) {
+            break;
+        }
+        if (!client.closing) {
+            client.in.append(buf, n);
+        }
+    }
+    if (client.closing) {
+        return;
+    }
+    if (!client.websocket && !handleRequest(fd, client)) {
+        return;
+    }
+    if (client.websocket && !handleFrames(client)) {
+        client.closing = true;
+        client.out.clear();
+    }
+    flush(fd, client);
+}
+
+// false until a whole request has arrived or once the client is answered and closing
+bool WebServer::handleRequest(int fd, Client& client) {
+    size_t end = client.in.find("\r\n\r\n");
+    if (end == std::string::npos) {
+        if (client.in.size() > MAX_REQUEST) {
+            client.closing = true;
+            client.out.clear();
+        }
+        return false;
+    }
+    std::string head = client.in.substr(0, end);
+    client.in.erase(0, end + 4);
+    std::string method, path, key, upgrade, origin;
+    size_t line_end = head.find("\r\n");
+    std::string request_line = head.substr(0, line_end);
+    size_t space = request_line.find(' ');
+    method = request_line.substr(0, space);
+    if (space != std::string::npos) {
+        path = request_line.substr(space + 1, request_line.find(' ', space + 1) - space - 1);
+    }
+    while (line_end != std::string::npos) {
+        size_t start = line_end + 2;
+        line_end = head.find("\r\n", start);
+        std::string line = head.substr(start, line_end == std::string::npos ? std::string::npos : line_end - start);
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string name = line.substr(0, colon);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        std::string value = line.substr(std::min(line.find_first_not_of(' ', colon + 1), line.size()));
+        if (name == "sec-websocket-key") {
+            key = value;
+        } else if (name == "upgrade") {
+            upgrade = value;
+            std::transform(upgrade.begin(), upgrade.end(), upgrade.begin(), ::tolower);
+        } else if (name == "origin") {
+            origin = value;
+        }
+    }
+    client.closing = true;
+    if (method != "GET") {
+        send(fd, client, Response("405 Method Not Allowed", "text/plain", "GET only\n"));
+    } else if (path == "/" || path == "/index.html") {
+        send(fd, client, Response("200 OK", "text/html; charset=utf-8", pad_page));
+    } else if (path != "/ws") {
+        send(fd, client, Response("404 Not Found", "text/plain", "not found\n"));
+    } else if (upgrade != "websocket" || key.empty()) {
+        send(fd, client, Response("400 Bad Request", "text/plain", "expected a WebSocket upgrade\n"));
+    } else if (!origin.empty() && origin != "http://127.0.0.1:" + std::to_string(_port) && origin != "http://localhost:" + std::to_string(_port)) {
+        // any site open in the browser could otherwise reach the board through localhost
+        send(fd, client, Response("403 Forbidden", "text/plain", "only the pad page can connect\n"));
+    } else {
+        client.closing = false;
+        client.websocket = true;
+        std::string accept = Base64(Sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"));
+        send(fd, client, "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: " + accept + "\r\n\r\n");
+        AudioEngine::Snapshot s = _engine.snapshot();
+        if (_library_frame.empty() || s.library_revision != _library_revision) {
+            // goes out to every page, this one included
+            push(true);
+        } else {
+            send(fd, client, _library_frame);
+        }
+        send(fd, client, StateFrame(s));
+        return true;
+    }
+    return false;
+}
+
+// false on a protocol error
+bool WebServer::handleFrames(Client& client) {
+    std::string& in = client.in;
+    while (in.size() >= 2) {
+        unsigned char b0 = in[0], b1 = in[1];
+        size_t length = b1 & 0x7f, pos = 2;
+        if (length == 126) {
+            if (in.size() < 4) {
+                return true;
+            }
+            length = ((size_t)(unsigned char)in[2] << 8) | (unsigned char)in[3];
+            pos = 4;
+        } else if (length == 127) {
+            if (in.size() < 10) {
+                return true;
+            }
+            length = 0;
+            for (int i = 2; i < 10; i++) {
+                length = (length << 8) | (unsigned char)in[i];
+            }
+            pos = 10;
+        }
+        // browsers always mask, and the page only sends short whole messages
+        if (!(b1 & 0x80) || length > MAX_MESSAGE || !(b0 & 0x80) || (b0 & 0x0f) == 0x0) {
+            return false;
+        }
+        if (in.size() < pos + 4 + length) {
+            return true;
+        }
+        std::string payload = in.substr(pos + 4, length);
+        for (size_t i = 0; i < length; i++) {
+            payload[i] ^= in[pos + (i % 4)];
+        }
+        in.erase(0, pos + 4 + length);
+        switch (b0 & 0x0f) {
+            case 0x1:
+                command(payload);
+                break;
+            case 0x8:
+                client.out += Frame("", 0x8);
+                client.closing = true;
+                in.clear();
+                return true;
+            case 0x9:
+                client.out += Frame(payload, 0xA);
+                break;
+        }
+    }
+    return true;
+}
+
+void WebServer::command(const std::string& text) {
+    AudioEngine::Batch batch;
+    batch.sent = Clock::now();
+    batch.count = 1;
+    AudioEngine::Command& c = batch.commands[0];
+    c = {AudioEngine::Command::Play, SoundId(), "", 0.0f};
+    char verb[16] = "";
+    int n = sscanf(text.c_str(), "%15s %u.%u %f", verb, &c.id.index, &c.id.generation, &c.value);
+    if (!strcmp(verb, "play") && n >= 3) {
+        c.kind = AudioEngine::Command::Play;
+    } else if (!strcmp(verb, "stop")) {
+        c.kind = AudioEngine::Command::Stop;
+        if (n < 3) {
+            c.id = SoundId();
+        }
+    } else if (!strcmp(verb, "volume") && n == 4) {
+        c.kind = AudioEngine::Command::Volume;
+    } else if (!strcmp(verb, "master") && sscanf(text.c_str(), "%*s %f", &c.value) == 1) {
+        c.kind = AudioEngine::Command::MasterVolume;
+    } else {
+        TraceLog(LOG_DEBUG, "Web server: unknown command \"%s\".", text.c_str());
+        return;
+    }
+    // an id that no longer resolves would look like a plain stop to the engine
+    if (c.kind != AudioEngine::Command::MasterVolume && n >= 3 && !c.id.valid()) {
+        return;
+    }
+    if (!_engine.post(batch)) {
+        TraceLog(LOG_WARNING, "Web server: the audio engine queue is full, dropped a command.");
+    }
+}
+
+// playback state is read from the engine's snapshot. the list is only copied, under mutex(), when its revision moved
+void WebServer::push(bool library_due) {
+    AudioEngine::Snapshot s = _engine.snapshot();
+    if (library_due && (s.library_revision != _library_revision || _library_frame.empty())) {
+        std::vector<std::pair<SoundId, std::string>> sounds;
+        {
+            std::lock_guard<std::mutex> guard(_engine.mutex());
+            _library_revision = _library.revision();
+            const std::vector<SoundId>& order = _library.order();
+            sounds.reserve(order.size());
+            for (SoundId id : order) {
+                sounds.push_back({id, _library.get(id)->name});
+            }
+        }
+        nlohmann::json list = nlohmann::json::array();
+        for (auto& s : sounds) {
+            list.push_back({{"id", IdString(s.first)}, {"name", s.second}});
+        }
+        _library_frame = Frame(nlohmann::json({{"library", list}}).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace));
+        for (auto& c : _clients) {
+            if (c.second.websocket && !c.second.closing) {
+                send(c.first, c.second, _library_frame);
+            }
+        }
+    }
+    if (!Changed(s, _pushed)) {
+        return;
+    }
+    _pushed = s;
+    std::string frame = StateFrame(s);
+    for (auto& c : _clients) {
+        if (c.second.websocket && !c.second.closing) {
+            send(c.first, c.second, frame);
+        }
+    }
+}
+
+void WebServer::send(int fd, Client& client, const std::string& data) {
+    if (client.out.size() + data.size() > MAX_PENDING_OUTPUT) {
+        client.closing = true;
+        client.out.clear();
+        return;
+    }
+    client.out += data;
+    flush(fd, client);
+}
+
+void WebServer::flush(int fd, Client& client) {
+    while (!client.out.empty()) {
+        ssize_t n = ::send(fd, client.out.data(), client.out.size(), MSG_NOSIGNAL);
+        if (n > 0) {
+            client.out.erase(0, n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // the rest goes out when the socket drains
+            if (client.writable) {
+                epoll_event event = {};
+                event.events = EPOLLIN | EPOLLOUT;
+                event.data.fd = fd;
+                epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, fd, &event);
+                client.writable = false;
+            }
+            return;
+        }
+        client.closing = true;
+        client.out.clear();
+        return;
+    }
+    if (!client.writable) {
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, fd, &event);
+        client.writable = true;
+    }
+}
+#else
+bool WebServer::start(int port) {
+    TraceLog(LOG_ERROR, "The web server isn't supported on this platform yet.");
+    return false;
+}
+
+void WebServer::stop() {}
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "AudioEngine.hpp"
+#include "SoundLibrary.hpp"
+
+// pad page for a browser on the same machine, served over HTTP on 127.0.0.1 only.
+// one thread runs everything on epoll: the page, and a WebSocket per open page that gets
+//   {"library": [{"id": "3.1", "name": ...}, ...]} when connecting and whenever the list changes
+//   {"current": "3.1", "playing": true, "position": s, "length": s, "level": 0-1, "master": 0-1} while something changes
+// and sends back "play <id>", "stop [id]", "volume <id> <0-2>" or "master <0-1>".
+// playback state comes from the engine's snapshot, the list is copied under mutex() only after it changed.
+class WebServer {
+    public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr auto PUSH_PERIOD = std::chrono::milliseconds(50);
+    static constexpr auto LIBRARY_PUSH_PERIOD = std::chrono::milliseconds(500);
+    static constexpr size_t MAX_CLIENTS = 256;
+    static constexpr size_t MAX_REQUEST = 8192;
+    static constexpr size_t MAX_MESSAGE = 4096;
+    // a page that stops reading is dropped once this much is waiting for it
+    static constexpr size_t MAX_PENDING_OUTPUT = 4 << 20;
+    private:
+    struct Client {
+        std::string in, out;
+        bool websocket=false;
+        bool closing=false; // closed once out is sent
+        bool writable=true; // false while EPOLLOUT is wanted
+    };
+    AudioEngine& _engine;
+    SoundLibrary& _library;
+    std::thread _thread;
+    int _listen_fd=-1, _epoll_fd=-1, _wake_fd=-1;
+    std::atomic<bool> _stopping{false};
+    unsigned short _port=0;
+    std::map<int, Client> _clients;
+    std::string _library_frame;
+    uint32_t _library_revision=0;
+    AudioEngine::Snapshot _pushed;
+    void work();
+    void accept();
+    void receive(int fd, Client& client);
+    bool handleRequest(int fd, Client& client);
+    bool handleFrames(Client& client);
+    void command(const std::string& text);
+    void push(bool library_due);
+    void send(int fd, Client& client, const std::string& data);
+    void flush(int fd, Client& client);
+    void drop(int fd);
+    public:
+    WebServer(AudioEngine& engine, SoundLibrary& library) : _engine(engine), _library(library) {}
+    ~WebServer();
+    bool start(int port);
+    void stop();
+    bool running() const {
+        return _listen_fd >= 0;
+    }
+    unsigned short port() const {
+        return _port;
+    }
+};
@@ -1,12 +1,19 @@
 #include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <cstdarg>
+#include <csignal>
 #include <cstdio>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <functional>
 #include <map>
+#include <mutex>
 #include <random>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 
 #include "../include/nlohmann/json.hpp"
@@ -16,65 +23,209 @@
 #include "../thirdparty/imgui-docking/imgui/imgui.h"
 
 #include "JsonConfig.hpp"
+#include "MetadataCache.hpp"
 #include "FileDialogs.hpp"
 using namespace FileDialogs;
 #include "ConfiguredMusic.hpp"
+#include "SoundLoader.hpp"
+#include "FolderScanner.hpp"
+#include "FolderWatcher.hpp"
+#include "SoundLibrary.hpp"
+#include "ConsoleLog.hpp"
+#include "AudioEngine.hpp"
+#include "FrameProfiler.hpp"
+#include "ControlSocket.hpp"
+#include "GlobalHotkeys.hpp"
+#include "OscServer.hpp"
+#include "WebServer.hpp"
+#include "Autosaver.hpp"
+#include "SoundBundle.hpp"
+#include "Scenes.hpp"
 
-std::vector<ConfiguredMusic*> loaded_sounds;
-std::map<std::string, unsigned int> loaded_sounds_by_path;
-std::map<unsigned int, unsigned int> sound_keybinds;
-std::vector<std::string> console_window_lines;
+SoundLibrary sound_library;
+std::map<unsigned int, SoundId> sound_keybinds; // hotkey (raylib key | HOTKEY_* modifiers) -> sound
+ConsoleLog console_log;
 std::vector<ma_device_info> available_playback_devices;
+SoundLoader sound_loader;
+SceneWarmer scene_warmer;
+AudioEngine audio_engine(sound_library);
+FolderScanner folder_scanner;
+FolderWatcher folder_watcher;
+GlobalHotkeys global_hotkeys;
+OscServer osc_server(audio_engine);
+WebServer web_server(audio_engine, sound_library);
+std::vector<std::string> imported_folders;
+#if !PRODUCTION_BUILD
+FrameProfiler frame_profiler;
+#endif
+
+// held only while sounds or the list change, the window reads them unlocked as it draws since nothing else
+// changes them. removed entries are compacted away before unlocking, so other threads calling order() only read
+class SoundsLock {
+    std::unique_lock<std::mutex> _guard;
+    public:
+    SoundsLock() : _guard(audio_engine.mutex()) {}
+    ~SoundsLock() {
+        unlock();
+    }
+    void lock() {
+        _guard.lock();
+    }
+    void unlock() {
+        if (_guard.owns_lock()) {
+            sound_library.compact();
+            _guard.unlock();
+        }
+    }
+};
+
+// sound whose hotkey is being chosen, key events don't trigger sounds meanwhile
+SoundId binding_sound;
+
+bool IsModifierKey(int key) {
+    return key >= KEY_LEFT_SHIFT && key <= KEY_RIGHT_SUPER;
+}
+
+unsigned int HeldModifiers() {
+    unsigned int mods = 0;
+    if (IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) {
+        mods |= HOTKEY_CTRL;
+    }
+    if (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT)) {
+        mods |= HOTKEY_SHIFT;
+    }
+    if (IsKeyDown(KEY_LEFT_ALT) || IsKeyDown(KEY_RIGHT_ALT)) {
+        mods |= HOTKEY_ALT;
+    }
+    if (IsKeyDown(KEY_LEFT_SUPER) || IsKeyDown(KEY_RIGHT_SUPER)) {
+        mods |= HOTKEY_SUPER;
+    }
+    return mods;
+}
+
+// runs on the main thread as glfw delivers the key, also while the frame loop sleeps waiting for events.
+// the sound is started by the audio engine right away instead of on the next frame.
+void __KeyEventCallback(int key, bool pressed) {
+    auto now = AudioEngine::Clock::now();
+    // global hotkeys see the key as well, whether or not the window has focus
+    if (!pressed || binding_sound.valid() || global_hotkeys.running() || ImGui::GetCurrentContext() == nullptr || ImGui::GetIO().WantTextInput) {
+        return;
+    }
+    auto it = sound_keybinds.find(key | HeldModifiers());
+    if (it != sound_keybinds.end()) {
+        audio_engine.trigger(it->second, now);
+    }
+}
+
+std::string KeyNameWithoutModifiers(int key) {
+    if (key > KEY_SPACE && key <= KEY_GRAVE) {
+        return std::string(1, (char)key);
+    }
+    if (key >= KEY_F1 && key <= KEY_F12) {
+        return "F" + std::to_string(key - KEY_F1 + 1);
+    }
+    if (key >= KEY_KP_0 && key <= KEY_KP_9) {
+        return "Keypad " + std::to_string(key - KEY_KP_0);
+    }
+    switch (key) {
+        case KEY_SPACE: return "Space";
+        case KEY_INSERT: return "Insert";
+        case KEY_HOME: return "Home";
+        case KEY_END: return "End";
+        case KEY_PAGE_UP: return "Page Up";
+        case KEY_PAGE_DOWN: return "Page Down";
+        case KEY_PAUSE: return "Pause";
+        case KEY_KP_DECIMAL: return "Keypad .";
+        case KEY_KP_DIVIDE: return "Keypad /";
+        case KEY_KP_MULTIPLY: return "Keypad *";
+        case KEY_KP_SUBTRACT: return "Keypad -";
+        case KEY_KP_ADD: return "Keypad +";
+        case KEY_KP_ENTER: return "Keypad Enter";
+    }
+    return "Key " + std::to_string(key);
+}
+
+std::string KeyName(unsigned int hotkey) {
+    std::string mods;
+    if (hotkey & HOTKEY_CTRL) {
+        mods += "Ctrl+";
+    }
+    if (hotkey & HOTKEY_SHIFT) {
+        mods += "Shift+";
+    }
+    if (hotkey & HOTKEY_ALT) {
+        mods += "Alt+";
+    }
+    if (hotkey & HOTKEY_SUPER) {
+        mods += "Super+";
+    }
+    int key = hotkey & ~HOTKEY_MODIFIERS;
+    return mods + KeyNameWithoutModifiers(key);
+}
 
 void __TraceLogCallback(int level, const char* fmt, va_list va) {
-    std::string levels[] = {
-        "TRACE",
-        "DEBUG",
-        "INFO",
-        "WARN",
-        "ERROR",
-        "FATAL",
-    };
-    char buffer[1024];
-    if (level <= 0 || level > LOG_ERROR) {
-        level = 1;
-    }
-    std::string console_line = "[" + levels[level - 1] + "] ";
-    printf("%s", console_line.c_str());
-    vsnprintf(buffer, sizeof(buffer), fmt, va);
-    printf("%s\n", buffer);
-    console_line += std::string(buffer);
-    console_window_lines.push_back(console_line);
+    // with a callback installed raylib doesn't exit on a fatal error and the board keeps going, as before.
+    // the error also goes to stderr, the failure may keep the window from ever showing the console
+    if (level >= LOG_FATAL) {
+        va_list copy;
+        va_copy(copy, va);
+        fprintf(stderr, "[FATAL] ");
+        vfprintf(stderr, fmt, copy);
+        fprintf(stderr, "\n");
+        va_end(copy);
+    }
+    console_log.push(level, fmt, va);
 }
 
-bool ImportSoundList(nlohmann::json j, nlohmann::json sound_configs) {
+bool ImportSoundList(const nlohmann::json& j, const SoundSettingsStore& sound_settings) {
     int count = 0;
-    if (!j.contains("paths")) {
-        return false;
-    }
-    nlohmann::json json = j["paths"];
-    if (!json.is_array()) {
+    auto json = j.find("paths");
+    if (json == j.end() || !json->is_array()) {
         return false;
     }
-    for (auto p : json) {
+    for (auto& p : *json) {
         if (p.is_string()) {
-            std::string k = p.get<std::string>();
-            nlohmann::json cfg;
-            ConfiguredMusic* cs;
-            if (sound_configs.contains(k)) {
-                cfg = sound_configs[k];
-            }
-            cs = ConfiguredMusic::Load(k, cfg);
-            loaded_sounds.push_back(cs);
-            loaded_sounds_by_path.insert(std::make_pair(k, loaded_sounds.size()-1));
+            const std::string& k = p.get_ref<const std::string&>();
+            if (sound_library.contains(k)) {
+                continue;
+            }
+            sound_loader.enqueue(k, sound_settings.get(k));
             count++;
         }
     }
-    TraceLog(LOG_INFO, "Imported %d sounds.", count);
+    TraceLog(LOG_INFO, "Importing %d sounds.", count);
     return true;
 }
 
-bool ImportSoundList(std::string fname, nlohmann::json sound_configs) {
+// lists every sound of the bundle, they were saved with their settings and metadata so nothing is probed
+static bool ImportBundle(const std::string& fname, const SoundSettingsStore& sound_settings) {
+    SoundBundle* bundle = SoundBundle::Mount(fname);
+    if (bundle == nullptr) {
+        return false;
+    }
+    int count = 0;
+    for (const SoundBundle::Entry& e : bundle->entries()) {
+        std::string p = SoundBundle::MemberPath(fname, e.name);
+        if (sound_library.contains(p)) {
+            continue;
+        }
+        // settings changed since the bundle was imported before win over the ones packed with it
+        const SoundSettings& settings = sound_settings.get(p).present != 0 ? sound_settings.get(p) : e.settings;
+        if (e.metadata.valid()) {
+            sound_library.add(p, ConfiguredMusic::LoadLazy(p, settings, e.metadata));
+        } else {
+            sound_loader.enqueue(p, settings);
+        }
+        count++;
+    }
+    TraceLog(LOG_INFO, "Imported %d sounds from bundle \"%s\".", count, fname.c_str());
+    return true;
+}
+
+bool ImportSoundList(const std::string& fname, const SoundSettingsStore& sound_settings) {
+    if (SoundBundle::IsBundle(fname)) {
+        return ImportBundle(fname, sound_settings);
+    }
     std::ifstream fd(fname);
     if (fd.is_open()) {
         nlohmann::json json;
@@ -85,23 +236,26 @@ bool ImportSoundList(std::string fname, nlohmann::json sound_configs) {
             TraceLog(LOG_ERROR, "Failed to import sounds from list \"%s\": %s", fname.c_str(), error.what());
             return false;
         }
-        return ImportSoundList(json, sound_configs);
+        if (!json.is_object()) {
+            return false;
+        }
+        return ImportSoundList(json, sound_settings);
     }
     return false;
 }
 
-bool ExportSoundList(std::string p, std::map<std::string, unsigned int> paths) {
+bool ExportSoundList(std::string p, SoundLibrary& library) {
     std::ofstream fd(p);
     if (fd.is_open()) {
         nlohmann::json json = nlohmann::json::array();
-        for (auto e : paths) {
-            json.push_back(e.first);
+        for (SoundId id : library.order()) {
+            json.push_back(library.pathOf(id));
         }
         json = {{"paths", json}};
         try {
             fd << json.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore);
             fd.close();
-            TraceLog(LOG_INFO, "Exported %d sounds.", paths.size());
+            TraceLog(LOG_INFO, "Exported %d sounds.", library.size());
             return true;
         } catch (nlohmann::detail::exception ignored) {}
     }
@@ -109,13 +263,449 @@ bool ExportSoundList(std::string p, std::map<std::string, unsigned int> paths) {
     return false;
 }
 
+// packs every listed sound with its settings into one file
+static bool ExportBundle(std::string p, SoundLibrary& library) {
+    if (!SoundBundle::IsBundle(p)) {
+        p += SoundBundle::EXTENSION;
+    }
+    std::vector<SoundBundle::Source> sources;
+    {
+        // the engine updates play counts and metadata, the files are written without the lock
+        SoundsLock guard;
+        for (SoundId id : library.order()) {
+            ConfiguredMusic* cs = library.get(id);
+            sources.push_back({library.pathOf(id), cs->Save(), cs->metadata});
+        }
+    }
+    auto start = std::chrono::steady_clock::now();
+    int count = SoundBundle::Write(p, sources);
+    if (count < 0) {
+        return false;
+    }
+    std::error_code ec;
+    TraceLog(LOG_INFO, "Exported %d sounds to bundle \"%s\" (%.1f MiB) in %.0f ms.", count, p.c_str(),
+        std::filesystem::file_size(p, ec) / 1048576.0, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return true;
+}
+
+// sounds in a bundle take their metadata from its index, anything else from the cache. invalid if neither knows it
+static SoundMetadata LookupMetadata(const std::string& p, MetadataCache& metadata_cache) {
+    SoundMetadata md;
+    SoundBundle* bundle;
+    const SoundBundle::Entry* entry;
+    if (SoundBundle::Locate(p, bundle, entry)) {
+        md = entry->metadata;
+    } else {
+        metadata_cache.lookup(p, md);
+    }
+    return md;
+}
+
+// lists the sounds without opening them, entries without known metadata are probed by the sound loader
+static void LoadSounds(const std::vector<std::string>& paths, const SoundSettingsStore& sound_settings, MetadataCache& metadata_cache) {
+    for (const std::string& p : paths) {
+        if (sound_library.contains(p)) {
+            continue;
+        }
+        const SoundSettings& settings = sound_settings.get(p);
+        SoundMetadata md = LookupMetadata(p, metadata_cache);
+        if (!md.valid()) {
+            sound_loader.enqueue(p, settings);
+        }
+        sound_library.add(p, ConfiguredMusic::LoadLazy(p, settings, md));
+    }
+}
+
+// bound sounds have their decoder opened ahead by the sound loader, short ones preloaded, so their first trigger
+// doesn't wait on it. caller holds the engine lock
+static void OpenBound(SoundId id) {
+    if (ConfiguredMusic* cs = sound_library.get(id)) {
+        cs->preload = true;
+        audio_engine.open(id);
+    }
+}
+
+// hotkey -> sound path in the config
+static void LoadKeybinds(const JsonConfig& config) {
+    std::map<std::string, std::string> keybinds = config.get<std::map<std::string, std::string>>("sound_keybinds");
+    SoundsLock guard;
+    for (auto& kb : keybinds) {
+        SoundId id = sound_library.find(kb.second);
+        if (sound_library.get(id) != nullptr) {
+            sound_keybinds[strtoul(kb.first.c_str(), nullptr, 10)] = id;
+            OpenBound(id);
+        }
+    }
+}
+
+static bool StartGlobalHotkeys(GlobalHotkeys::Backend backend) {
+    bool started = global_hotkeys.start(backend, [] (SoundId id, GlobalHotkeys::Clock::time_point pressed) {
+        audio_engine.trigger(id, pressed);
+    });
+    global_hotkeys.setBindings(sound_keybinds);
+    return started;
+}
+
+// takes a finished load from the sound loader, returns true if it added a new sound
+static bool MergeLoaded(SoundLoader::Result& r, MetadataCache& metadata_cache) {
+    metadata_cache.store(r.path, r.music->metadata);
+    if (ConfiguredMusic* cs = sound_library.get(sound_library.find(r.path))) {
+        // already listed (startup cache miss or duplicate import), only fill in the metadata
+        if (!cs->loaded) {
+            bool length_was_known = cs->metadata.valid();
+            cs->metadata = r.music->metadata;
+            cs->length = cs->metadata.length;
+            if (!length_was_known || cs->end_time > cs->length) {
+                cs->end_time = cs->length;
+            }
+        }
+        delete r.music;
+        return false;
+    }
+    sound_library.add(r.path, r.music);
+    return true;
+}
+
+static ControlSocket* headless_control = nullptr;
+static volatile sig_atomic_t headless_stopping = 0;
+
+static void HeadlessSignalHandler(int) {
+    headless_stopping = 1;
+    if (headless_control != nullptr) {
+        headless_control->wake();
+    }
+}
+
+// runs one control socket command and returns the reply, the last line of a reply starts with "ok" or "error".
+// the headless board and the window share these, the window also answers "show" and "scene"
+static std::string RemoteCommand(const std::string& line, SoundId& current_sound, float& global_volume, const SoundSettingsStore& sound_settings, bool& shutdown) {
+    size_t space = line.find(' ');
+    std::string command = line.substr(0, space);
+    std::string arg;
+    if (space != std::string::npos && line.find_first_not_of(' ', space) != std::string::npos) {
+        arg = line.substr(line.find_first_not_of(' ', space));
+    }
+    ConfiguredMusic* current = sound_library.get(current_sound);
+    if (command == "list") {
+        std::string reply;
+        const std::vector<SoundId>& order = sound_library.order();
+        for (size_t i = 0; i < order.size(); i++) {
+            reply += std::to_string(i) + "\t" + sound_library.get(order[i])->name + "\t" + sound_library.pathOf(order[i]) + "\n";
+        }
+        return reply + "ok " + std::to_string(order.size()) + "\n";
+    } else if (command == "play" || command == "next") {
+        SoundId id = current_sound;
+        if (command == "next") {
+            id = sound_library.next(current_sound);
+        } else if (arg.size() > 0 && arg.find_first_not_of("0123456789") == std::string::npos) {
+            size_t i = strtoul(arg.c_str(), nullptr, 10);
+            id = i < sound_library.order().size() ? sound_library.order()[i] : SoundId();
+        } else if (arg.size() > 0) {
+            id = sound_library.find(arg);
+            if (!id.valid()) {
+                id = sound_library.findByName(arg);
+            }
+            // a file that isn't listed yet is added, the engine has it opened
+            std::error_code ec;
+            if (!id.valid() && std::filesystem::is_regular_file(arg, ec)) {
+                id = sound_library.add(arg, ConfiguredMusic::LoadLazy(arg, sound_settings.get(arg), SoundMetadata()));
+            }
+        }
+        ConfiguredMusic* cs = sound_library.get(id);
+        if (cs == nullptr) {
+            return "error no such sound\n";
+        }
+        if (cs->load_failed) {
+            return "error failed to open " + sound_library.pathOf(id) + "\n";
+        }
+        if (id == current_sound && arg.empty() && command == "play" && cs->started) {
+            cs->Resume();
+        } else {
+            if (current != nullptr) {
+                current->Stop();
+            }
+            current_sound = id;
+            audio_engine.trigger(id, AudioEngine::Clock::now());
+        }
+        return "ok " + cs->name + "\n";
+    } else if (command == "pause") {
+        if (current != nullptr) {
+            current->Pause();
+        }
+        return "ok\n";
+    } else if (command == "stop") {
+        if (current != nullptr) {
+            current->Stop();
+        }
+        return "ok\n";
+    } else if (command == "volume") {
+        if (arg.size() > 0) {
+            char* end;
+            float v = strtof(arg.c_str(), &end);
+            if (end == arg.c_str()) {
+                return "error volume is a number from 0 to 1\n";
+            }
+            global_volume = std::clamp(v, 0.0f, 1.0f);
+            SetMasterVolume(global_volume);
+        }
+        return "ok " + std::to_string(global_volume) + "\n";
+    } else if (command == "import") {
+        if (!ImportSoundList(arg, sound_settings)) {
+            return "error can't import \"" + arg + "\"\n";
+        }
+        return "ok\n";
+    } else if (command == "show") {
+        if (IsWindowReady()) {
+            if (IsWindowMinimized()) {
+                RestoreWindow();
+            }
+            SetWindowFocused();
+        }
+        return "ok\n";
+    } else if (command == "shutdown") {
+        shutdown = true;
+        return "ok\n";
+    }
+    return "error unknown command, expected list, play [index|path|name], next, pause, stop, volume [0-1], import <list>, show or shutdown\n";
+}
+
+// the board without a window: plays the sounds from config.json as told over the control socket.
+// the main thread sleeps in poll() until a command arrives or the audio engine reports a sound ending.
+static int RunHeadless(ControlSocket& control, const std::vector<std::string>& startup_commands) {
+    InitAudioDevice();
+    if (!IsAudioDeviceReady()) {
+        TraceLog(LOG_ERROR, "Failed to init audio device!");
+        return 1;
+    }
+    headless_control = &control;
+    signal(SIGINT, HeadlessSignalHandler);
+    signal(SIGTERM, HeadlessSignalHandler);
+
+    float global_volume = 1.0f;
+    bool play_in_sequence = false;
+    SoundId current_sound;
+    JsonConfig config("config.json", {
+        {"global_volume", global_volume},
+        {"play_in_sequence", play_in_sequence},
+        {"currently_playing", ""},
+        {"loaded_sounds", {}},
+        {"sound_keybinds", nlohmann::json::object()},
+        {"global_hotkeys", false},
+        {"hotkey_backend", "x11"},
+        {"osc_server", false},
+        {"osc_address", "127.0.0.1"},
+        {"osc_port", 9000},
+        {"web_server", false},
+        {"web_port", 8080},
+    });
+    MetadataCache metadata_cache("metadata_cache.json");
+    metadata_cache.load();
+    global_volume = config.get<float>("global_volume");
+    play_in_sequence = config.get<bool>("play_in_sequence");
+    SoundSettingsStore sound_settings;
+    sound_settings.load(config["sound_configs"]);
+    LoadSounds(config.get<std::vector<std::string>>("loaded_sounds"), sound_settings, metadata_cache);
+    current_sound = sound_library.find(config.get<std::string>("currently_playing"));
+    LoadKeybinds(config);
+    SetMasterVolume(global_volume);
+    TraceLog(LOG_INFO, "Headless with %d sounds.", (int)sound_library.size());
+    {
+        std::lock_guard<std::mutex> guard(audio_engine.mutex());
+        audio_engine.setWake([&control] { control.wake(); });
+    }
+    // there are no window key events here, bound keys only work as global hotkeys
+    if (config.get<bool>("global_hotkeys")) {
+        StartGlobalHotkeys(config.get<std::string>("hotkey_backend") == "evdev" ? GlobalHotkeys::Evdev : GlobalHotkeys::X11);
+    }
+    if (config.get<bool>("osc_server")) {
+        osc_server.start(config.get<std::string>("osc_address"), config.get<int>("osc_port"));
+    }
+    if (config.get<bool>("web_server")) {
+        web_server.start(config.get<int>("web_port"));
+    }
+
+    // commands given on the command line run first, there is no client to answer
+    std::vector<ControlSocket::Command> commands;
+    for (auto& line : startup_commands) {
+        commands.push_back({0, line});
+    }
+    std::vector<SoundLoader::Result> loader_results;
+    while (!headless_stopping) {
+        // metadata probes for sounds missing from the cache are picked up every so often, otherwise only events wake the loop
+        if (commands.empty()) {
+            control.wait(commands, sound_loader.isBusy() ? 100 : -1);
+        }
+        SoundsLock guard;
+        audio_engine.takeTriggered(current_sound);
+        audio_engine.takeMasterVolume(global_volume);
+        loader_results.clear();
+        sound_loader.drain(loader_results, 256);
+        for (auto& r : loader_results) {
+            if (r.music == nullptr) {
+                TraceLog(LOG_ERROR, "Failed to load sound file: \"%s\"", r.path.c_str());
+            } else {
+                MergeLoaded(r, metadata_cache);
+            }
+        }
+        for (auto& c : commands) {
+            bool shutdown = false;
+            control.reply(c.client, RemoteCommand(c.line, current_sound, global_volume, sound_settings, shutdown));
+            if (shutdown) {
+                headless_stopping = 1;
+            }
+        }
+        commands.clear();
+        if (audio_engine.takeEnded() && play_in_sequence && sound_library.size() > 1) {
+            current_sound = sound_library.next(current_sound);
+            audio_engine.trigger(current_sound, AudioEngine::Clock::now(), false);
+        }
+        audio_engine.setCurrent(current_sound);
+    }
+
+    // the config belongs to the windowed board, only the metadata learned here is kept
+    TraceLog(LOG_INFO, "Shutting down.");
+    metadata_cache.save();
+    headless_control = nullptr;
+    control.close();
+    global_hotkeys.stop();
+    osc_server.stop();
+    web_server.stop();
+    audio_engine.stop();
+    folder_watcher.stop();
+    folder_scanner.stop();
+    sound_loader.stop();
+    CloseAudioDevice();
+    return 0;
+}
+
+// relative to where the command was typed, the running instance may have another working directory
+static std::string AbsoluteIfExists(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::path absolute = std::filesystem::absolute(path, ec);
+    if (ec || !std::filesystem::exists(absolute, ec)) {
+        return path;
+    }
+    return NarrowString16To8(absolute.wstring());
+}
+
+#if !PRODUCTION_BUILD
+// startup cost of a board with count sounds: loading config.json as text against its binary copy
+static int BenchmarkConfigLoad(int count) {
+    nlohmann::json data = {
+        {"global_volume", 1.0f},
+        {"play_in_sequence", false},
+        {"loaded_sounds", nlohmann::json::array()},
+        {"sound_configs", nlohmann::json::object()},
+    };
+    for (int i = 0; i < count; i++) {
+        std::string path = "/home/user/Music/Soundboard/Folder " + std::to_string(i / 100) + "/Sound " + std::to_string(i) + ".ogg";
+        data["loaded_sounds"].push_back(path);
+        data["sound_configs"][path] = {
+            {"v", 1.0f}, {"s", 1.0f}, {"p", 0.5f}, {"r", false}, {"a", false},
+            {"st", 0.0f}, {"et", 2.5f + i % 60}, {"da", 1700000000 + i}, {"pc", i % 13}, {"tg", ""},
+        };
+    }
+    std::error_code ec;
+    std::filesystem::path dir = std::filesystem::temp_directory_path(ec) / "soundboard-config-bench";
+    std::filesystem::create_directories(dir, ec);
+    std::string filename = (dir / "config.json").string();
+    if (!JsonConfig::Write(filename, data)) {
+        TraceLog(LOG_ERROR, "Config load test: could not write to %s", dir.string().c_str());
+        return 1;
+    }
+    TraceLog(LOG_INFO, "Config load test, %d sounds: json %.1f KiB, cache %.1f KiB", count,
+        std::filesystem::file_size(filename, ec) / 1024.0, std::filesystem::file_size(ConfigCache::Filename(filename), ec) / 1024.0);
+    const int rounds = 10;
+    for (int binary = 0; binary < 2; binary++) {
+        double total = 0, best = 1e9;
+        for (int r = 0; r < rounds; r++) {
+            nlohmann::json loaded;
+            auto start = std::chrono::steady_clock::now();
+            bool ok = binary ? ConfigCache::Read(filename, loaded) : JsonConfig::ReadText(filename, loaded);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (!ok || loaded != data) {
+                TraceLog(LOG_ERROR, "Config load test: the %s did not load back", binary ? "cache" : "json");
+                return 1;
+            }
+            total += ms;
+            best = std::min(best, ms);
+        }
+        TraceLog(LOG_INFO, "    %s: avg %.2f ms, best %.2f ms", binary ? "cache" : "json", total / rounds, best);
+    }
+    {
+        SoundSettingsStore store;
+        auto start = std::chrono::steady_clock::now();
+        store.load(data["sound_configs"]);
+        TraceLog(LOG_INFO, "    settings store: %.2f ms for %d entries", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), (int)store.size());
+    }
+    std::filesystem::remove_all(dir, ec);
+    return 0;
+}
+#endif
 
 int main(int argc, char** argv) {
+    bool headless = false;
+    std::string socket_path = ControlSocket::DefaultPath();
+    std::vector<std::string> startup_commands;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--headless")) {
+            headless = true;
+        } else if (!strcmp(argv[i], "--socket") && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (!strcmp(argv[i], "--play") && i + 1 < argc) {
+            startup_commands.push_back("play " + AbsoluteIfExists(argv[++i]));
+        } else if (!strcmp(argv[i], "--import") && i + 1 < argc) {
+            startup_commands.push_back("import " + AbsoluteIfExists(argv[++i]));
+#if !PRODUCTION_BUILD
+        } else if (!strcmp(argv[i], "--bench-config")) {
+            return BenchmarkConfigLoad(i + 1 < argc && isdigit(argv[i + 1][0]) ? atoi(argv[i + 1]) : 10000);
+#endif
+        }
+    }
+
+    // one board per user. a later launch hands its command line to the running one and exits
+    // before opening a window or an audio device, a plain launch brings the window to the front
+    ControlSocket control;
+    ControlSocket::OpenResult opened = control.open(socket_path);
+    if (opened == ControlSocket::AlreadyRunning) {
+        if (startup_commands.empty()) {
+            if (headless) {
+                fprintf(stderr, "The soundboard is already running.\n");
+                return 1;
+            }
+            startup_commands.push_back("show");
+        }
+        std::string replies;
+        if (!ControlSocket::Send(socket_path, startup_commands, replies)) {
+            fprintf(stderr, "The running soundboard isn't answering on \"%s\".\n", socket_path.c_str());
+            return 1;
+        }
+        fputs(replies.c_str(), stdout);
+        return replies.compare(0, 5, "error") == 0 || replies.find("\nerror") != std::string::npos ? 1 : 0;
+    }
+    // decoders are opened on the loader's workers and handed to the engine, never under its lock
+    sound_loader.onOpened([] (SoundLoader::Opened& o) {
+        audio_engine.opened(o);
+    });
+    {
+        std::lock_guard<std::mutex> guard(audio_engine.mutex());
+        audio_engine.setOpener([] (SoundId id, const std::string& path, bool preload, const SoundMetadata& md) {
+            sound_loader.open(id, path, preload, md);
+        });
+    }
+    if (headless) {
+        if (opened != ControlSocket::Opened) {
+            return 1;
+        }
+        return RunHeadless(control, startup_commands);
+    }
+
     SetTraceLogCallback(__TraceLogCallback);
     SetConfigFlags(FLAG_VSYNC_HINT | FLAG_WINDOW_RESIZABLE);
     InitWindow(1000, 600, "Beck's Soundboard");
     SetTargetFPS(60);
     SetExitKey(-1);
+    SetKeyEventCallback(__KeyEventCallback);
     InitAudioDevice();
     if (IsAudioDeviceReady()) {
         TraceLog(LOG_INFO, "Initialized audio device.");
@@ -136,9 +726,7 @@ int main(int argc, char** argv) {
     std::random_device random_device;
     std::mt19937 random_generator(random_device());
 
-    // bool currently_loading_sound = false;
-    ConfiguredMusic* current_loaded_music = nullptr;
-    int current_loaded_music_index = -1;
+    SoundId current_sound;
     float global_volume = 1.0f;
     std::filesystem::path current_path = std::filesystem::current_path();
     FileDialog fileBrowser("Load Sound from Files");
@@ -153,61 +741,537 @@ int main(int argc, char** argv) {
         {"currently_playing", ""},
         {"loaded_sounds", {}},
         {"pinned_folders", {}},
+        {"imported_folders", {}},
+        {"sound_keybinds", nlohmann::json::object()},
+        {"current_scene", "Default"},
+        {"scenes", nlohmann::json::object()},
+        {"global_hotkeys", false},
+        {"hotkey_backend", "x11"},
+        {"osc_server", false},
+        {"osc_address", "127.0.0.1"},
+        {"osc_port", 9000},
+        {"web_server", false},
+        {"web_port", 8080},
     });
+    bool global_hotkeys_enabled = false;
+    GlobalHotkeys::Backend hotkey_backend = GlobalHotkeys::X11;
+    bool osc_enabled = false;
+    char osc_address[64] = "127.0.0.1";
+    int osc_port = 9000;
+    bool web_enabled = false;
+    int web_port = 8080;
+
+    // sounds are listed from cached metadata at startup, decoders are opened on first use.
+    // entries missing from the cache are probed by the sound loader.
+    MetadataCache metadata_cache("metadata_cache.json");
+    metadata_cache.load();
+    std::vector<SoundLoader::Result> loader_results;
+    unsigned int loader_added = 0, loader_failed = 0;
+    // a file picked in the browser becomes the current sound once it is listed, if there is none
+    std::string select_when_loaded;
 
-    nlohmann::json sound_configs;
-    if (config.load()) {
+    // settings of every sound in the config, sounds that are added again later get theirs back
+    SoundSettingsStore sound_settings;
+    // the active scene is the board itself, the others are kept here until they are switched to
+    std::string current_scene = "Default";
+    std::map<std::string, Scene> scenes;
+    if (config.loaded()) {
         global_volume = config.get<float>("global_volume");
         play_in_sequence = config.get<bool>("play_in_sequence");
         current_path = std::filesystem::path(config.get<std::string>("current_path"));
         std::vector<std::string> loaded_sound_paths = config.get<std::vector<std::string>>("loaded_sounds");
-        sound_configs = config.contains("sound_configs") ? config["sound_configs"] : nlohmann::json();
-        for (std::string p : loaded_sound_paths) {
-            nlohmann::json cfg;
-            ConfiguredMusic* cs;
-            if (sound_configs.contains(p)) {
-                cfg = sound_configs[p];
-            }
-            cs = ConfiguredMusic::Load(p, cfg);
-            loaded_sounds.push_back(cs);
-            loaded_sounds_by_path.insert(std::make_pair(p, loaded_sounds.size()-1));
-        }
+        sound_settings.load(config["sound_configs"]);
+        LoadSounds(loaded_sound_paths, sound_settings, metadata_cache);
         std::string currently_playing = config.get<std::string>("currently_playing");
         if (currently_playing.length() > 0) {
-            if (loaded_sounds_by_path.count(currently_playing)) {
-                current_loaded_music_index = loaded_sounds_by_path[currently_playing];
-                current_loaded_music = loaded_sounds[current_loaded_music_index];
-                current_loaded_music->started = false;
+            current_sound = sound_library.find(currently_playing);
+            if (ConfiguredMusic* cs = sound_library.get(current_sound)) {
+                cs->started = false;
             }
         }
         std::vector<std::string> pinned_folders = config.get<std::vector<std::string>>("pinned_folders");
         for (auto s : pinned_folders) {
             AddPinnedFolder(std::filesystem::path(s));
         }
+        imported_folders = config.get<std::vector<std::string>>("imported_folders");
+        for (auto& s : imported_folders) {
+            folder_watcher.watch(s, true);
+        }
+        LoadKeybinds(config);
+        if (!config.get<std::string>("current_scene").empty()) {
+            current_scene = config.get<std::string>("current_scene");
+        }
+        for (auto& [name, scene] : config["scenes"].items()) {
+            scenes[name] = Scene::FromJson(scene);
+        }
+        scenes.erase(current_scene);
+        global_hotkeys_enabled = config.get<bool>("global_hotkeys");
+        hotkey_backend = config.get<std::string>("hotkey_backend") == "evdev" ? GlobalHotkeys::Evdev : GlobalHotkeys::X11;
+        osc_enabled = config.get<bool>("osc_server");
+        snprintf(osc_address, sizeof(osc_address), "%s", config.get<std::string>("osc_address").c_str());
+        osc_port = config.get<int>("osc_port");
+        web_enabled = config.get<bool>("web_server");
+        web_port = config.get<int>("web_port");
     }
+    if (global_hotkeys_enabled) {
+        global_hotkeys_enabled = StartGlobalHotkeys(hotkey_backend);
+    }
+    if (osc_enabled) {
+        osc_enabled = osc_server.start(osc_address, osc_port);
+    }
+    if (web_enabled) {
+        web_enabled = web_server.start(web_port);
+    }
+
+    // removes the entry, stopping it first if it is the current one
+    auto remove_sound = [&] (SoundId id) {
+        if (id == current_sound) {
+            if (ConfiguredMusic* cs = sound_library.get(id)) {
+                cs->Stop();
+            }
+            current_sound = SoundId();
+        }
+        for (auto it = sound_keybinds.begin(); it != sound_keybinds.end();) {
+            it = it->second == id ? sound_keybinds.erase(it) : std::next(it);
+        }
+        sound_library.remove(id);
+    };
+    // paths a scene switch dropped while the loader may still be probing them, their results aren't listed
+    std::unordered_set<std::string> switched_out;
+    // the board as a scene, to keep it while another one is active
+    auto capture_scene = [&] () {
+        Scene scene;
+        scene.volume = global_volume;
+        scene.sounds.reserve(sound_library.size());
+        for (SoundId id : sound_library.order()) {
+            scene.sounds.emplace_back(sound_library.pathOf(id), sound_library.get(id)->Save());
+        }
+        for (auto& kb : sound_keybinds) {
+            if (sound_library.get(kb.second) != nullptr) {
+                scene.keybinds[kb.first] = sound_library.pathOf(kb.second);
+            }
+        }
+        return scene;
+    };
+    // hands the sounds of the scene that the board doesn't already list to the warmer. bound sounds and
+    // short clips get their decoders opened, bound ones first, up to MAX_OPEN of them
+    auto warm_scene = [&] (const std::string& name) {
+        auto it = scenes.find(name);
+        if (it == scenes.end()) {
+            return;
+        }
+        std::unordered_set<std::string> bound;
+        for (auto& kb : it->second.keybinds) {
+            bound.insert(kb.second);
+        }
+        std::vector<SceneWarmer::Job> jobs;
+        for (auto& [path, settings] : it->second.sounds) {
+            if (!sound_library.contains(path)) {
+                jobs.push_back({path, settings, LookupMetadata(path, metadata_cache), false});
+            }
+        }
+        std::stable_partition(jobs.begin(), jobs.end(), [&bound] (const SceneWarmer::Job& job) {
+            return bound.count(job.path) > 0;
+        });
+        size_t opened = 0;
+        for (auto& job : jobs) {
+            bool short_clip = job.metadata.valid() && job.metadata.length <= ConfiguredMusic::PRELOAD_MAX_LENGTH;
+            job.open = opened < SceneWarmer::MAX_OPEN && (bound.count(job.path) > 0 || short_clip);
+            opened += job.open;
+        }
+        scene_warmer.warm(name, std::move(jobs));
+    };
+    // puts the scene on the board. sounds both scenes list keep their open entry and only take the new settings,
+    // the others come from the warmer if it got to them and are listed lazily like at startup if it didn't
+    auto switch_scene = [&] (const std::string& name) {
+        auto it = scenes.find(name);
+        if (it == scenes.end()) {
+            return false;
+        }
+        auto start = std::chrono::steady_clock::now();
+        Scene next = std::move(it->second);
+        scenes.erase(it);
+        scenes[current_scene] = capture_scene();
+        std::unordered_map<std::string, size_t> position;
+        for (size_t i = 0; i < next.sounds.size(); i++) {
+            position.emplace(next.sounds[i].first, i);
+        }
+        // closing decoders can take a while, the warmer does it off this thread
+        std::vector<ConfiguredMusic*> dropped;
+        std::vector<SoundId> listed = sound_library.order();
+        for (SoundId id : listed) {
+            std::string path = sound_library.pathOf(id);
+            if (position.count(path) > 0) {
+                continue;
+            }
+            if (id == current_sound) {
+                current_sound = SoundId();
+            }
+            ConfiguredMusic* cs = sound_library.release(id);
+            if (cs->loaded) {
+                cs->Stop();
+            }
+            dropped.push_back(cs);
+            switched_out.insert(std::move(path));
+        }
+        // the warmer unloads and deletes them on its own thread, the engine lets go of them first
+        audio_engine.setCurrent(current_sound);
+        scene_warmer.discard(std::move(dropped));
+        size_t kept = sound_library.size(), warmed = 0;
+        for (auto& [path, settings] : next.sounds) {
+            SoundId id = sound_library.find(path);
+            if (ConfiguredMusic* cs = sound_library.get(id)) {
+                cs->Load(settings);
+                if (cs->loaded) {
+                    cs->Update();
+                }
+                sound_library.reindex(id);
+                continue;
+            }
+            ConfiguredMusic* cs = scene_warmer.take(name, path);
+            if (cs != nullptr) {
+                warmed++;
+            } else {
+                cs = ConfiguredMusic::LoadLazy(path, settings, LookupMetadata(path, metadata_cache));
+            }
+            if (!cs->loaded && !cs->metadata.valid()) {
+                sound_loader.enqueue(path, settings);
+            }
+            switched_out.erase(path);
+            sound_library.add(path, cs);
+        }
+        sound_library.sort([&position] (SoundId a, SoundId b) {
+            return position[sound_library.pathOf(a)] < position[sound_library.pathOf(b)];
+        });
+        sound_keybinds.clear();
+        binding_sound = SoundId();
+        for (auto& [key, path] : next.keybinds) {
+            SoundId id = sound_library.find(path);
+            if (sound_library.get(id) != nullptr) {
+                sound_keybinds[key] = id;
+                OpenBound(id);
+            }
+        }
+        global_volume = next.volume;
+        SetMasterVolume(global_volume);
+        scene_warmer.cancel();
+        TraceLog(LOG_INFO, "Switched to scene \"%s\" in %.1f ms: %d sounds, %d kept open, %d warmed.", name.c_str(),
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+            (int)next.sounds.size(), (int)kept, (int)warmed);
+        current_scene = name;
+        return true;
+    };
+    std::vector<std::filesystem::path> watched_pinned_folders;
+    std::vector<FolderWatcher::Event> watcher_events;
+    scene_warmer.start();
 
     SetMasterVolume(global_volume);
 
-    while (!WindowShouldClose()) {
+    // without the socket the board still works, it just can't be driven by later launches
+    ControlThread control_thread(control);
+    if (opened == ControlSocket::Opened) {
+        control_thread.start(WakeEventWaiting);
+    }
+    std::vector<ControlSocket::Command> remote_commands;
+    for (auto& line : startup_commands) {
+        remote_commands.push_back({0, line});
+    }
+    bool remote_shutdown = false;
+
+    // everything the board keeps in config.json, the metadata cache is only written at exit
+    auto store_config = [&] () {
+        config.set("global_volume", global_volume);
+        config.set("play_in_sequence", play_in_sequence);
+        config.set("current_path", current_path.string());
+        config.set("currently_playing", sound_library.pathOf(current_sound));
+        std::vector<std::string> saved_sound_paths;
+        nlohmann::json saved_sound_configs;
+        for (SoundId id : sound_library.order()) {
+            saved_sound_paths.push_back(sound_library.pathOf(id));
+            saved_sound_configs[saved_sound_paths.back()] = sound_library.get(id)->Save().toJson();
+        }
+        config.set("loaded_sounds", std::move(saved_sound_paths));
+        config.set("sound_configs", std::move(saved_sound_configs));
+        std::vector<std::filesystem::path> pinned_folder_paths = GetPinnedFolders();
+        std::vector<std::string> pinned_folders;
+        for (auto p : pinned_folder_paths) {
+            pinned_folders.push_back(NarrowString16To8(p.wstring()));
+        }
+        config.set("pinned_folders", pinned_folders);
+        config.set("imported_folders", imported_folders);
+        nlohmann::json saved_keybinds = nlohmann::json::object();
+        for (auto& kb : sound_keybinds) {
+            if (sound_library.get(kb.second) != nullptr) {
+                saved_keybinds[std::to_string(kb.first)] = sound_library.pathOf(kb.second);
+            }
+        }
+        config.set("sound_keybinds", saved_keybinds);
+        config.set("current_scene", current_scene);
+        nlohmann::json saved_scenes = nlohmann::json::object();
+        for (auto& [name, scene] : scenes) {
+            saved_scenes[name] = scene.toJson();
+        }
+        config.set("scenes", std::move(saved_scenes));
+        config.set("global_hotkeys", global_hotkeys_enabled);
+        config.set("hotkey_backend", hotkey_backend == GlobalHotkeys::Evdev ? "evdev" : "x11");
+        config.set("osc_server", osc_enabled);
+        config.set("osc_address", std::string(osc_address));
+        config.set("osc_port", osc_port);
+        config.set("web_server", web_enabled);
+        config.set("web_port", web_port);
+    };
+    // a crash loses at most the last few seconds of changes instead of the whole session
+    Autosaver autosaver(config.filename());
+    autosaver.start(WakeEventWaiting);
+
+    while (!WindowShouldClose() && !remote_shutdown) {
         static float dt = 0;
+        PROFILE_BEGIN_FRAME(frame_profiler);
+        PROFILE_MARK(frame_profiler, "Audio lock wait");
+        // events and finished loads are applied under the engine lock, it is released before drawing
+        SoundsLock audio_guard;
+        PROFILE_MARK(frame_profiler, "Events & loading");
+        AudioEngine::Latency latency = audio_engine.latency();
+        {
+            SoundId triggered;
+            if (audio_engine.takeTriggered(triggered)) {
+                current_sound = triggered;
+                autosaver.touch();
+            }
+            if (audio_engine.takeMasterVolume(global_volume)) {
+                autosaver.touch();
+            }
+        }
+        control_thread.take(remote_commands);
+        if (!remote_commands.empty()) {
+            autosaver.touch();
+        }
+        for (auto& c : remote_commands) {
+            // scenes only exist on the window's board
+            if (c.line.compare(0, 6, "scene ") == 0) {
+                std::string name = c.line.substr(6);
+                bool switched = name == current_scene || switch_scene(name);
+                control_thread.reply(c.client, switched ? "ok " + name + "\n" : "error no such scene\n");
+                continue;
+            }
+            control_thread.reply(c.client, RemoteCommand(c.line, current_sound, global_volume, sound_settings, remote_shutdown));
+        }
+        remote_commands.clear();
+        if (binding_sound.valid()) {
+            // the next key pressed with the modifiers held becomes the hotkey, escape cancels and backspace unbinds the sound
+            int key;
+            while ((key = GetKeyPressed()) != 0 && IsModifierKey(key)) {}
+            if (key != 0) {
+                if (key == KEY_BACKSPACE || key == KEY_DELETE) {
+                    for (auto it = sound_keybinds.begin(); it != sound_keybinds.end();) {
+                        it = it->second == binding_sound ? sound_keybinds.erase(it) : std::next(it);
+                    }
+                } else if (key != KEY_ESCAPE) {
+                    sound_keybinds[key | HeldModifiers()] = binding_sound;
+                    OpenBound(binding_sound);
+                }
+                binding_sound = SoundId();
+                autosaver.touch();
+            }
+        }
+        {
+            static std::map<unsigned int, SoundId> global_bindings;
+            if (global_hotkeys.running() && global_bindings != sound_keybinds) {
+                global_bindings = sound_keybinds;
+                global_hotkeys.setBindings(global_bindings);
+            }
+        }
+        size_t console_new_lines = console_log.drain();
+        if (unsigned int dropped = console_log.dropped()) {
+            TraceLog(LOG_WARNING, "Console queue was full, dropped %u messages.", dropped);
+        }
+        // pinned folders are watched for changes to sounds already in the list, they don't import new files
+        {
+            std::vector<std::filesystem::path> pinned = GetPinnedFolders();
+            if (pinned != watched_pinned_folders) {
+                for (auto& p : watched_pinned_folders) {
+                    if (std::find(imported_folders.begin(), imported_folders.end(), NarrowString16To8(p.wstring())) == imported_folders.end()) {
+                        folder_watcher.unwatch(p);
+                    }
+                }
+                for (auto& p : pinned) {
+                    if (std::find(imported_folders.begin(), imported_folders.end(), NarrowString16To8(p.wstring())) == imported_folders.end()) {
+                        folder_watcher.watch(p, false);
+                    }
+                }
+                watched_pinned_folders = pinned;
+            }
+        }
+        watcher_events.clear();
+        folder_watcher.poll(watcher_events);
+        for (auto& e : watcher_events) {
+            if (e.kind == FolderWatcher::Event::Removed) {
+                SoundId id = sound_library.find(e.path);
+                if (ConfiguredMusic* cs = sound_library.get(id)) {
+                    TraceLog(LOG_INFO, "Removed sound \"%s\", the file is gone.", cs->name.c_str());
+                    remove_sound(id);
+                }
+            } else if (e.kind == FolderWatcher::Event::FolderRemoved) {
+                std::string prefix = e.path + "/";
+                std::vector<SoundId> gone;
+                for (SoundId id : sound_library.order()) {
+                    if (sound_library.pathOf(id).compare(0, prefix.size(), prefix) == 0) {
+                        gone.push_back(id);
+                    }
+                }
+                for (SoundId id : gone) {
+                    remove_sound(id);
+                }
+                if (gone.size() > 0) {
+                    TraceLog(LOG_INFO, "Removed %d sounds, \"%s\" is gone.", (int)gone.size(), e.path.c_str());
+                }
+            } else if (ConfiguredMusic* cs = sound_library.get(sound_library.find(e.path))) {
+                // rewritten in place, reopen it the next time it is used and refresh its metadata
+                if (sound_library.find(e.path) == current_sound) {
+                    cs->Stop();
+                }
+                cs->Unload();
+                cs->load_failed = false;
+                sound_loader.enqueue(e.path, cs->Save());
+            } else if (e.import_new) {
+                sound_loader.enqueue(e.path, sound_settings.get(e.path));
+            }
+        }
+        // scanned folders feed the loader as they are walked
+        {
+            static std::vector<std::string> scanned_paths;
+            scanned_paths.clear();
+            folder_scanner.drain(scanned_paths, 4096);
+            for (auto& p : scanned_paths) {
+                if (sound_library.contains(p)) {
+                    continue;
+                }
+                sound_loader.enqueue(p, sound_settings.get(p));
+            }
+        }
+        // finished loads are merged in batches so a large import doesn't stall a single frame
+        loader_results.clear();
+        sound_loader.drain(loader_results, 256);
+        for (auto& r : loader_results) {
+            if (r.music == nullptr) {
+                TraceLog(LOG_ERROR, "Failed to load sound file: \"%s\"", r.path.c_str());
+                loader_failed++;
+                continue;
+            }
+            if (switched_out.count(r.path) > 0) {
+                // probed for a scene that is no longer on the board
+                metadata_cache.store(r.path, r.music->metadata);
+                delete r.music;
+                continue;
+            }
+            if (MergeLoaded(r, metadata_cache)) {
+                loader_added++;
+                if (r.path == select_when_loaded && sound_library.get(current_sound) == nullptr) {
+                    current_sound = sound_library.find(r.path);
+                }
+            }
+        }
+        if (!sound_loader.isBusy()) {
+            switched_out.clear();
+        }
+        if (loader_results.size() > 0 && !sound_loader.isBusy()) {
+            if (loader_added > 0 || loader_failed > 0) {
+                TraceLog(LOG_INFO, "Loaded %u sounds, %u failed.", loader_added, loader_failed);
+            }
+            loader_added = loader_failed = 0;
+            select_when_loaded.clear();
+        }
+        audio_guard.unlock();
+        PROFILE_MARK(frame_profiler, "BeginDrawing");
         BeginDrawing();
         ClearBackground(BLACK);
 
         rlImGuiBegin();
+        PROFILE_MARK(frame_profiler, "otherFileBrowsers.show");
         otherFileBrowsers.show();
+        PROFILE_MARK(frame_profiler, "Options");
         ImGui::Begin("Options");
         ImGui::SetWindowPos({1.0f, 1.0f}, ImGuiCond_FirstUseEver);
         ImGui::SetWindowSize({400.0f, 200.0f}, ImGuiCond_FirstUseEver);
         if (ImGui::SliderFloat("Volume", &global_volume, 0.0f, 1.0f)) {
+            SoundsLock guard;
             SetMasterVolume(global_volume);
         }
         if (ImGui::Checkbox("Play in Sequence", &play_in_sequence)) {}
         if (ImGui::Checkbox("Scroll Log to Bottom", &scroll_log_to_bottom)) {}
+#if !PRODUCTION_BUILD
+        static bool show_list_stress_test = false;
+        if (ImGui::Checkbox("List Stress Test", &show_list_stress_test)) {}
+        static bool show_frame_profiler = false;
+        if (ImGui::Checkbox("Frame Profiler", &show_frame_profiler)) {}
+#endif
+        if (latency.count > 0) {
+            ImGui::Text("Trigger to first sample: last %.1f ms, avg %.1f ms, max %.1f ms", latency.last_ms, latency.total_ms / latency.count, latency.max_ms);
+        }
+        if (ImGui::Checkbox("Global Hotkeys", &global_hotkeys_enabled)) {
+            if (global_hotkeys_enabled) {
+                global_hotkeys_enabled = StartGlobalHotkeys(hotkey_backend);
+            } else {
+                global_hotkeys.stop();
+            }
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100.0f);
+        int backend_index = hotkey_backend;
+        const char* backend_names[] = {"X11", "evdev"};
+        if (ImGui::Combo("Backend", &backend_index, backend_names, IM_ARRAYSIZE(backend_names))) {
+            hotkey_backend = (GlobalHotkeys::Backend)backend_index;
+            if (global_hotkeys_enabled) {
+                global_hotkeys_enabled = StartGlobalHotkeys(hotkey_backend);
+            }
+        }
+        if (ImGui::Checkbox("OSC Server", &osc_enabled)) {
+            if (osc_enabled) {
+                osc_enabled = osc_server.start(osc_address, osc_port);
+            } else {
+                osc_server.stop();
+            }
+        }
+        // the address can only be changed while the server is off
+        ImGui::BeginDisabled(osc_server.running());
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(120.0f);
+        ImGui::InputText("##OscAddress", osc_address, sizeof(osc_address));
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(90.0f);
+        ImGui::InputInt("Port##Osc", &osc_port, 0);
+        ImGui::EndDisabled();
+        if (ImGui::Checkbox("Web Server", &web_enabled)) {
+            if (web_enabled) {
+                web_enabled = web_server.start(web_port);
+            } else {
+                web_server.stop();
+            }
+        }
+        ImGui::SameLine();
+        if (web_server.running()) {
+            ImGui::Text("http://127.0.0.1:%d/", (int)web_server.port());
+        } else {
+            ImGui::SetNextItemWidth(90.0f);
+            ImGui::InputInt("Port##Web", &web_port, 0);
+        }
+#if !PRODUCTION_BUILD
+        if (osc_server.running()) {
+            ImGui::BeginDisabled(osc_server.benchmarking() || sound_library.size() == 0);
+            if (ImGui::Button("OSC Latency Test")) {
+                osc_server.startBenchmark(50);
+            }
+            ImGui::EndDisabled();
+        }
+#endif
         ImGui::Text("Available Playback Devices");
+        // workers open decoders against the current device, don't swap it from under them
+        ImGui::BeginDisabled(sound_loader.isBusy() || scene_warmer.isBusy());
         for (int i=0; i<available_playback_devices.size(); i++) {
             auto dev = &available_playback_devices[i];
             ImGui::PushID(i);
             if (ImGui::Button("Select")) {
+                SoundsLock guard;
                 CloseAudioDevice();
                 InitAudioDeviceByID(&dev->id);
                 SetMasterVolume(global_volume);
@@ -216,34 +1280,45 @@ int main(int argc, char** argv) {
             ImGui::Text("%s", dev->name);
             ImGui::PopID();
         }
+        ImGui::EndDisabled();
         ImGui::End();
+        PROFILE_MARK(frame_profiler, "Sounds");
         ImGui::Begin("Sounds");
         ImGui::SetWindowPos({402.0f, 1.0f}, ImGuiCond_FirstUseEver);
         ImGui::SetWindowSize({400.0f, 200.0f}, ImGuiCond_FirstUseEver);
         if (ImGui::Button("Import")) {
-            otherFileBrowsers.openIfNotAlready("Import Sound List", [&sound_configs] (std::string p) {
-                return ImportSoundList(p, sound_configs);
+            otherFileBrowsers.openIfNotAlready("Import Sound List", [&sound_settings] (std::string p) {
+                SoundsLock guard;
+                return ImportSoundList(p, sound_settings);
             });
         }
         ImGui::SameLine();
         if (ImGui::Button("Export")) {
             otherFileBrowsers.openIfNotAlready("Export Sound List", [] (std::string p) {
-                return ExportSoundList(p, loaded_sounds_by_path);
+                return ExportSoundList(p, sound_library);
+            }, true);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Export Bundle")) {
+            otherFileBrowsers.openIfNotAlready("Export Bundle", [] (std::string p) {
+                return ExportBundle(p, sound_library);
             }, true);
         }
         ImGui::SameLine();
         static bool clear_ays = false;
         if (ImGui::Button(clear_ays ? "Are you sure?" : "Clear")) {
             if (clear_ays) {
-                for (auto e : loaded_sounds) {
-                    if (e != nullptr) {
-                        e->Unload();
-                    }
+                SoundsLock guard;
+                sound_library.clear();
+                sound_keybinds.clear();
+                binding_sound = SoundId();
+                for (auto& p : imported_folders) {
+                    folder_watcher.unwatch(p);
                 }
-                loaded_sounds.clear();
-                loaded_sounds_by_path.clear();
-                current_loaded_music = nullptr;
-                current_loaded_music_index = -1;
+                imported_folders.clear();
+                // pinned folders that were also imported are picked up again next frame
+                watched_pinned_folders.clear();
+                current_sound = SoundId();
                 clear_ays = false;
             } else {
                 clear_ays = true;
@@ -251,197 +1326,438 @@ int main(int argc, char** argv) {
         }
         ImGui::SameLine();
         if (ImGui::Button("Import Folder")) {
-            otherFileBrowsers.openIfNotAlready("Import from Folder", [&sound_configs] (std::string path) {
-                auto files = DirList(path, false, true);
-                for (auto f : files) {
-                    std::string p = NarrowString16To8(f.wstring());
-                    if (loaded_sounds_by_path.count(p) > 0) {
-                        continue;
-                    }
-                    nlohmann::json cfg;
-                    if (sound_configs.contains(p)) {
-                        cfg = sound_configs[p];
-                    }
-                    ConfiguredMusic* cs;
-                    if ((cs = ConfiguredMusic::Load(p, cfg))) {
-                        loaded_sounds.push_back(cs);
-                        loaded_sounds_by_path.insert(std::make_pair(p, loaded_sounds.size()-1));
-                        TraceLog(LOG_INFO, "Loaded sound file successfuly: \"%s\"", p.c_str());
-                    } else {
-                        TraceLog(LOG_ERROR, "Failed to load sound file: \"%s\"", p.c_str());
-                    }
+            otherFileBrowsers.openIfNotAlready("Import from Folder", [] (std::string path) {
+                folder_scanner.scan(path);
+                if (std::find(imported_folders.begin(), imported_folders.end(), path) == imported_folders.end()) {
+                    imported_folders.push_back(path);
+                    folder_watcher.watch(path, true);
                 }
                 return false;
             }, false, true);
         }
-        if (ImGui::Button("Sort A-Z")) {
-            std::vector<ConfiguredMusic*> newList;
-            for (auto m : loaded_sounds)
-                if (m != nullptr) newList.push_back(m);
-            loaded_sounds_by_path.clear();
-            auto& f = std::use_facet<std::ctype<wchar_t>>(std::locale());
-            std::sort(loaded_sounds.begin(), loaded_sounds.end(), [&f](ConfiguredMusic* ia, ConfiguredMusic* ib) -> bool {
-                std::wstring as = ia->path.wstring();
-                std::wstring bs = ib->path.wstring();
-                return std::lexicographical_compare(
-                    as.begin(), as.end(), bs.begin(), bs.end(), [&f](wchar_t ai, wchar_t bi) {
-                        return f.tolower(ai) < f.tolower(bi);
-                });
-            });
-            for (unsigned int i = 0; i < loaded_sounds.size(); i++) {
-                loaded_sounds_by_path.insert(std::make_pair(NarrowString16To8(loaded_sounds[i]->path.wstring()), i));
+        if (folder_scanner.isBusy()) {
+            ImGui::Text("Scanning: %u files, %u sounds", folder_scanner.scanned(), folder_scanner.matched());
+        }
+        if (sound_loader.isBusy() || folder_scanner.isBusy()) {
+            unsigned int total = sound_loader.total(), completed = sound_loader.completed();
+            char progress_buffer[32];
+            snprintf(progress_buffer, sizeof(progress_buffer), "%u/%u", completed, total);
+            ImGui::ProgressBar(total > 0 ? (float)completed / total : 0.0f, {-80.0f, 0.0f}, progress_buffer);
+            ImGui::SameLine();
+            if (ImGui::Button("Cancel")) {
+                folder_scanner.cancel();
+                sound_loader.cancel();
+                TraceLog(LOG_INFO, "Cancelled loading sounds.");
+            }
+        }
+        // every order compares fields cached on the entries, nothing is converted per comparison
+        static int sort_order = 0;
+        const char* sort_orders[] = {"A-Z", "Length", "Newest", "Most Played"};
+        if (ImGui::Button("Sort")) {
+            SoundsLock guard;
+            auto by_name = [](SoundId ia, SoundId ib) -> bool {
+                return sound_library.get(ia)->sort_key < sound_library.get(ib)->sort_key;
+            };
+            switch (sort_order) {
+                case 0:
+                    sound_library.sort(by_name);
+                    break;
+                case 1:
+                    sound_library.sort([](SoundId ia, SoundId ib) -> bool {
+                        return sound_library.get(ia)->length < sound_library.get(ib)->length;
+                    });
+                    break;
+                case 2:
+                    sound_library.sort([](SoundId ia, SoundId ib) -> bool {
+                        return sound_library.get(ia)->date_added > sound_library.get(ib)->date_added;
+                    });
+                    break;
+                case 3:
+                    sound_library.sort([](SoundId ia, SoundId ib) -> bool {
+                        return sound_library.get(ia)->play_count > sound_library.get(ib)->play_count;
+                    });
+                    break;
             }
         }
         ImGui::SameLine();
+        ImGui::SetNextItemWidth(110.0f);
+        ImGui::Combo("##SortOrder", &sort_order, sort_orders, IM_ARRAYSIZE(sort_orders));
+        ImGui::SameLine();
         if (ImGui::Button("Shuffle")) {
-            std::vector<ConfiguredMusic*> newList;
-            for (auto m : loaded_sounds)
-                if (m != nullptr) newList.push_back(m);
-            std::shuffle(loaded_sounds.begin(), loaded_sounds.end(), random_generator);
-            loaded_sounds_by_path.clear();
-            for (unsigned int i = 0; i < loaded_sounds.size(); i++) {
-                loaded_sounds_by_path.insert(std::make_pair(NarrowString16To8(loaded_sounds[i]->path.wstring()), i));
-            }
+            SoundsLock guard;
+            sound_library.shuffle(random_generator);
         }
 
-        for (int i=0; i<loaded_sounds.size(); i++) {
-            auto sound = loaded_sounds[i];
-            if (sound == nullptr) continue;
-            ImGui::PushID(i);
-            if (ImGui::Button("Remove")) {
-                if (current_loaded_music == sound) {
-                    StopMusicStream(sound->music);
-                    current_loaded_music = nullptr;
-                    current_loaded_music_index++;
-                    if (current_loaded_music_index >= loaded_sounds.size()) {
-                        if (loaded_sounds.size() > 0) {
-                            current_loaded_music_index = 0;
-                        } else {
-                            current_loaded_music_index = -1;
-                        }
+        // results are only recomputed when the query or the library changes
+        static char search_buffer[256] = "";
+        static std::string search_query;
+        static uint32_t search_revision = 0;
+        static std::vector<SoundId> search_results;
+        static int search_highlight = 0;
+        ImGui::SetNextItemWidth(-1.0f);
+        bool search_submitted = ImGui::InputTextWithHint("##Search", "Search (Enter plays the highlighted match)", search_buffer, sizeof(search_buffer), ImGuiInputTextFlags_EnterReturnsTrue);
+        bool searching = search_buffer[0] != 0;
+        if (searching && (search_query != search_buffer || search_revision != sound_library.revision())) {
+            search_query = search_buffer;
+            search_revision = sound_library.revision();
+            search_results = sound_library.search(search_query, 500);
+            search_highlight = 0;
+        }
+        bool search_highlight_moved = false;
+        if (searching && ImGui::IsItemActive()) {
+            if (ImGui::IsKeyPressed(ImGuiKey_DownArrow) && search_highlight + 1 < (int)search_results.size()) {
+                search_highlight++;
+                search_highlight_moved = true;
+            }
+            if (ImGui::IsKeyPressed(ImGuiKey_UpArrow) && search_highlight > 0) {
+                search_highlight--;
+                search_highlight_moved = true;
+            }
+        }
+        if (searching && search_submitted) {
+            if (search_highlight < (int)search_results.size()) {
+                SoundId id = search_results[search_highlight];
+                if (sound_library.get(id) != nullptr) {
+                    SoundsLock guard;
+                    if (ConfiguredMusic* previous = sound_library.get(current_sound)) {
+                        previous->Stop();
                     }
+                    current_sound = id;
+                    audio_engine.trigger(id, AudioEngine::Clock::now());
                 }
-                UnloadMusicStream(sound->music);
-                delete sound;
-                loaded_sounds[i] = sound = nullptr;
             }
-            ImGui::SameLine();
-            if (sound != nullptr) {
+            ImGui::SetKeyboardFocusHere(-1);
+        }
+
+        SoundId removed_sound;
+        const std::vector<SoundId>& listed_sounds = searching ? search_results : sound_library.order();
+        // the list scrolls on its own below the controls, only the visible rows are submitted
+        ImGui::BeginChild("SoundList");
+        ImGuiListClipper sound_clipper;
+        sound_clipper.Begin(listed_sounds.size());
+        if (search_highlight_moved) {
+            sound_clipper.ForceDisplayRangeByIndices(search_highlight, search_highlight + 1);
+        }
+        while (sound_clipper.Step()) {
+            for (int row = sound_clipper.DisplayStart; row < sound_clipper.DisplayEnd; row++) {
+                SoundId id = listed_sounds[row];
+                ConfiguredMusic* sound = sound_library.get(id);
+                if (sound == nullptr) {
+                    // keeps the row height uniform for the clipper
+                    ImGui::TextUnformatted("");
+                    continue;
+                }
+                ImGui::PushID(id.index);
+                if (searching && row == search_highlight) {
+                    ImGui::PushStyleColor(ImGuiCol_Text, {1.0f, 1.0f, 0.4f, 1.0f});
+                }
+                if (ImGui::Button("Remove")) {
+                    // removing while iterating would compact the order list under us
+                    removed_sound = id;
+                }
+                ImGui::SameLine();
                 if (ImGui::Button("Select")) {
-                    current_loaded_music = sound;
-                    current_loaded_music_index = i;
+                    current_sound = id;
+                }
+                ImGui::SameLine();
+                std::string key_label = "Bind Key";
+                for (auto& kb : sound_keybinds) {
+                    if (kb.second == id) {
+                        key_label = KeyName(kb.first);
+                        break;
+                    }
+                }
+                if (binding_sound == id) {
+                    key_label = "Press a key...";
+                }
+                if (ImGui::Button((key_label + "###Key").c_str())) {
+                    binding_sound = binding_sound == id ? SoundId() : id;
                 }
                 ImGui::SameLine();
                 ImGui::Text("%s", sound->name.c_str());
+                if (searching && row == search_highlight) {
+                    ImGui::PopStyleColor();
+                    if (search_highlight_moved) {
+                        ImGui::SetScrollHereY();
+                    }
+                }
+                ImGui::PopID();
+            }
+        }
+        ImGui::EndChild();
+        if (removed_sound.valid()) {
+            SoundsLock guard;
+            remove_sound(removed_sound);
+        }
+        ImGui::End();
+        PROFILE_MARK(frame_profiler, "Scenes");
+        ImGui::Begin("Scenes");
+        ImGui::SetWindowPos({804.0f, 1.0f}, ImGuiCond_FirstUseEver);
+        ImGui::SetWindowSize({300.0f, 200.0f}, ImGuiCond_FirstUseEver);
+        {
+            // a new scene starts empty or as a copy of the board
+            static char scene_name[64] = "";
+            ImGui::SetNextItemWidth(140.0f);
+            ImGui::InputTextWithHint("##SceneName", "Scene name", scene_name, sizeof(scene_name));
+            ImGui::BeginDisabled(scene_name[0] == 0 || scene_name == current_scene || scenes.count(scene_name) > 0);
+            ImGui::SameLine();
+            if (ImGui::Button("New")) {
+                scenes[scene_name] = Scene();
+                scene_name[0] = 0;
+                autosaver.touch();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Copy")) {
+                SoundsLock guard;
+                scenes[scene_name] = capture_scene();
+                scene_name[0] = 0;
+                autosaver.touch();
+            }
+            ImGui::EndDisabled();
+            std::string warming = scene_warmer.scene();
+            if (!warming.empty()) {
+                size_t ready, total;
+                scene_warmer.progress(ready, total);
+                char progress_buffer[96];
+                snprintf(progress_buffer, sizeof(progress_buffer), "%s: %u/%u", warming.c_str(), (unsigned int)ready, (unsigned int)total);
+                ImGui::ProgressBar(total > 0 ? (float)ready / total : 1.0f, {-1.0f, 0.0f}, progress_buffer);
+            }
+            ImGui::Text("%s (%d sounds)", current_scene.c_str(), (int)sound_library.size());
+            // choosing a scene starts warming it, the board only changes on Switch
+            std::string switch_to, deleted_scene;
+            for (auto& [name, scene] : scenes) {
+                ImGui::PushID(name.c_str());
+                if (ImGui::Button("Switch")) {
+                    switch_to = name;
+                }
+                ImGui::SameLine();
+                if (ImGui::Button("Delete")) {
+                    deleted_scene = name;
+                }
+                ImGui::SameLine();
+                if (ImGui::Selectable(name.c_str(), name == warming)) {
+                    warm_scene(name);
+                }
+                ImGui::PopID();
+            }
+            if (!switch_to.empty()) {
+                SoundsLock guard;
+                switch_scene(switch_to);
+                autosaver.touch();
+            }
+            if (!deleted_scene.empty()) {
+                if (deleted_scene == warming) {
+                    scene_warmer.cancel();
+                }
+                scenes.erase(deleted_scene);
+                autosaver.touch();
             }
-            ImGui::PopID();
         }
         ImGui::End();
-        ImGui::Begin("Console");
+        PROFILE_MARK(frame_profiler, "Console");
+        ImGui::Begin("Console", nullptr, ImGuiWindowFlags_HorizontalScrollbar);
         ImGui::SetWindowPos({1.0f, 202.0f}, ImGuiCond_FirstUseEver);
         ImGui::SetWindowSize({400.0f, 200.0f}, ImGuiCond_FirstUseEver);
-        for (auto line : console_window_lines) {
-            if (line.size() > 0)
-                ImGui::TextWrapped("%s", line.c_str());
+        {
+            static int console_min_level = LOG_INFO;
+            static std::vector<unsigned int> console_visible;
+            static bool console_visible_built = false;
+            const char* console_levels[] = {"Trace", "Debug", "Info", "Warnings", "Errors"};
+            int shown_level = console_min_level - LOG_TRACE;
+            ImGui::SetNextItemWidth(120.0f);
+            bool filter_changed = ImGui::Combo("Minimum Level", &shown_level, console_levels, IM_ARRAYSIZE(console_levels));
+            console_min_level = shown_level + LOG_TRACE;
+            ImGui::SameLine();
+            if (ImGui::Button("Clear##Console")) {
+                console_log.clear();
+                filter_changed = true;
+            }
+            // the filtered view is rebuilt only when lines arrive or the filter changes
+            if (filter_changed || console_new_lines > 0 || !console_visible_built) {
+                console_visible.clear();
+                for (size_t i = 0; i < console_log.size(); i++) {
+                    if (console_log.at(i).level >= console_min_level) {
+                        console_visible.push_back(i);
+                    }
+                }
+                console_visible_built = true;
+            }
+            // lines aren't wrapped so every row has the same height and the clipper can skip to the visible ones
+            ImGuiListClipper console_clipper;
+            console_clipper.Begin(console_visible.size());
+            while (console_clipper.Step()) {
+                for (int i = console_clipper.DisplayStart; i < console_clipper.DisplayEnd; i++) {
+                    ImGui::TextUnformatted(console_log.at(console_visible[i]).text);
+                }
+            }
         }
         if (scroll_log_to_bottom) {
-            ImGui::SetScrollY(ImGui::GetCursorPosY() - ImGui::GetWindowHeight());
+            ImGui::SetScrollY(ImGui::GetScrollMaxY());
         }
         ImGui::End();
+#if !PRODUCTION_BUILD
+        // compares submitting a large list in full against clipping it to the visible rows
+        PROFILE_MARK(frame_profiler, "Stress test");
+        if (show_list_stress_test) {
+            static int stress_rows = 100000;
+            static bool stress_clipped = true;
+            static double stress_ms = 0.0;
+            ImGui::Begin("List Stress Test", &show_list_stress_test);
+            ImGui::InputInt("Rows", &stress_rows);
+            ImGui::Checkbox("Virtualized", &stress_clipped);
+            ImGui::Text("List submit: %.3f ms, frame: %.2f ms", stress_ms, dt * 1000.0f);
+            if (ImGui::Button("Fill Console")) {
+                for (size_t i = 0; i < ConsoleLog::MAX_LINES; i++) {
+                    console_log.print(LOG_DEBUG, "stress test line %d", (int)i);
+                    if (i % (ConsoleLog::QUEUE_SIZE / 2) == 0) {
+                        console_log.drain();
+                    }
+                }
+            }
+            ImGui::BeginChild("StressRows");
+            double start = GetTime();
+            auto row = [](int i) {
+                ImGui::PushID(i);
+                ImGui::Button("Select");
+                ImGui::SameLine();
+                ImGui::Text("Stress test row %d", i);
+                ImGui::PopID();
+            };
+            if (stress_clipped) {
+                ImGuiListClipper clipper;
+                clipper.Begin(stress_rows);
+                while (clipper.Step()) {
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                        row(i);
+                    }
+                }
+            } else {
+                for (int i = 0; i < stress_rows; i++) {
+                    row(i);
+                }
+            }
+            stress_ms = stress_ms * 0.9 + (GetTime() - start) * 1000.0 * 0.1;
+            ImGui::EndChild();
+            ImGui::End();
+        }
+        PROFILE_MARK(frame_profiler, "Frame Profiler");
+        if (show_frame_profiler) {
+            frame_profiler.show(&show_frame_profiler);
+        }
+#endif
+        PROFILE_MARK(frame_profiler, "fileBrowser.Show");
         std::filesystem::path open_path;
         if (fileBrowser.Show(open_path)) {
-            nlohmann::json cfg;
             std::string p = NarrowString16To8(open_path.wstring());
-            if (sound_configs.contains(p)) {
-                cfg = sound_configs[p];
-            }
-            ConfiguredMusic* cs;
-            if ((cs = ConfiguredMusic::Load(p, cfg))) {
-                loaded_sounds.push_back(cs);
-                loaded_sounds_by_path.insert(std::make_pair(p, loaded_sounds.size()-1));
-                TraceLog(LOG_INFO, "Loaded sound file successfuly: \"%s\"", p.c_str());
+            if (sound_library.contains(p)) {
+                TraceLog(LOG_INFO, "Sound file is already loaded: \"%s\"", p.c_str());
             } else {
-                TraceLog(LOG_ERROR, "Failed to load sound file: \"%s\"", p.c_str());
+                // probed and listed by the loader, off this thread
+                sound_loader.enqueue(p, sound_settings.get(p));
+                select_when_loaded = p;
             }
-            if (cs != nullptr) {
-                cs->Update();
-                if (current_loaded_music == nullptr) {
-                    current_loaded_music = loaded_sounds[(current_loaded_music_index = loaded_sounds.size()-1)];
+        }
+        PROFILE_MARK(frame_profiler, "ConfiguredMusic::Show");
+        bool progress_visible = false;
+        {
+            // the panel edits the sound the engine is playing
+            SoundsLock guard;
+            if (ConfiguredMusic* current_loaded_music = sound_library.get(current_sound)) {
+                // opened ahead so playing it doesn't wait on the decoder
+                audio_engine.open(current_sound);
+                progress_visible = current_loaded_music->Show();
+                if (current_loaded_music->tags_changed) {
+                    current_loaded_music->tags_changed = false;
+                    sound_library.reindex(current_sound);
+                }
+                if (current_loaded_music->start_requested) {
+                    current_loaded_music->start_requested = false;
+                    audio_engine.trigger(current_sound, AudioEngine::Clock::now());
                 }
             }
         }
-        if (current_loaded_music) {
-            if (!current_loaded_music->Show(dt)) {
-                if (play_in_sequence && loaded_sounds.size() > 1) {
-                    current_loaded_music_index++;
-                    bool has_wrapped_around = false;
-                    if (current_loaded_music_index >= loaded_sounds.size()) {
-                        current_loaded_music_index = 0;
-                        has_wrapped_around = true;
-                    }
-                    while (loaded_sounds[current_loaded_music_index] == nullptr) {
-                        current_loaded_music_index++;
-                        if (current_loaded_music_index >= loaded_sounds.size()) {
-                            current_loaded_music_index = 0;
-                            if (has_wrapped_around) {
-                                break;
-                            }
-                            has_wrapped_around = true;
-                        }
-                    }
-                    current_loaded_music = loaded_sounds[current_loaded_music_index];
-                    if (current_loaded_music != nullptr) {
-                        PlayMusicStream(current_loaded_music->music);
-                        current_loaded_music->started = true;
-                    }
+        audio_guard.lock();
+        {
+            // a trigger since the top of the frame, setCurrent() below would undo it otherwise
+            SoundId triggered;
+            if (audio_engine.takeTriggered(triggered)) {
+                current_sound = triggered;
+            }
+        }
+        if (audio_engine.takeEnded() && play_in_sequence && sound_library.size() > 1) {
+            current_sound = sound_library.next(current_sound);
+            audio_engine.trigger(current_sound, AudioEngine::Clock::now(), false);
+        }
+        {
+            // a widget being let go is when settings change, the list and the current sound can also change without one
+            static bool was_editing = false;
+            static uint32_t seen_revision = sound_library.revision();
+            static SoundId seen_current = current_sound;
+            bool editing = ImGui::IsAnyItemActive();
+            if ((was_editing && !editing) || seen_revision != sound_library.revision() || seen_current != current_sound) {
+                autosaver.touch();
+            }
+            was_editing = editing;
+            seen_revision = sound_library.revision();
+            seen_current = current_sound;
+            if (autosaver.due()) {
+                PROFILE_MARK(frame_profiler, "Autosave");
+                store_config();
+                if (config.dirty()) {
+                    autosaver.save(config.data());
+                    config.markSaved();
                 }
             }
         }
+        audio_engine.setCurrent(current_sound);
+        audio_engine.wakeForProgress(progress_visible);
+        audio_guard.unlock();
+
+        // nothing changes on screen without input unless something is loading, then the frame loop sleeps
+        // until an event arrives. the audio engine and folder watcher wake it up for their own events.
+        bool background_work = sound_loader.isBusy() || folder_scanner.isBusy() || scene_warmer.isBusy();
+#if !PRODUCTION_BUILD
+        background_work |= show_list_stress_test;
+#endif
+        if (background_work) {
+            DisableEventWaiting();
+        } else {
+            EnableEventWaiting();
+        }
+        PROFILE_MARK(frame_profiler, "rlImGuiEnd");
         rlImGuiEnd();
-        // if (currently_loading_sound) {
-        //     static float loading_timer = 0;
-        //     DrawCircle(1, 1, 3, WHITE);
-        //     for (float ct=0.5f; ct<3.0f; ct+=0.5f) {
-        //         if (loading_timer >= ct) {
-        //             DrawCircle(1 + ct*6.0f, 1, 3, WHITE);
-        //         }
-        //     }
-        //     loading_timer += dt;
-        //     if (loading_timer >= 4.0f) {
-        //         loading_timer -= 4.0f;
-        //     }
-        // }
+        // also where the loop sleeps until the next event while idle
+        PROFILE_MARK(frame_profiler, "EndDrawing");
         EndDrawing();
+        PROFILE_RECORD(frame_profiler, "Audio thread, worst tick", audio_engine.takeWorstTick());
+        PROFILE_END_FRAME(frame_profiler);
         dt = GetFrameTime();
     }
 
-    config.set("global_volume", global_volume);
-    config.set("play_in_sequence", play_in_sequence);
-    config.set("current_path", current_path.string());
-    if (current_loaded_music) {
-        config.set("currently_playing", current_loaded_music->path.string());
-    } else {
-        config.set("currently_playing", "");
-    }
-    std::vector<std::string> saved_sound_paths;
-    nlohmann::json saved_sound_configs;
-    for (auto pair : loaded_sounds_by_path) {
-        auto cs = loaded_sounds[pair.second];
-        if (cs) {
-            saved_sound_paths.push_back(pair.first);
-            saved_sound_configs[pair.first] = cs->Save();
+    autosaver.stop();
+    {
+        SoundsLock guard;
+        for (SoundId id : sound_library.order()) {
+            ConfiguredMusic* cs = sound_library.get(id);
+            if (cs->loaded) {
+                metadata_cache.store(sound_library.pathOf(id), cs->metadata);
+            }
         }
+        store_config();
     }
-    config.set("loaded_sounds", saved_sound_paths);
-    config.set("sound_configs", saved_sound_configs);
-    std::vector<std::filesystem::path> pinned_folder_paths = GetPinnedFolders();
-    std::vector<std::string> pinned_folders;
-    for (auto p : pinned_folder_paths) {
-        pinned_folders.push_back(NarrowString16To8(p.wstring()));
-    }
-    config.set("pinned_folders", pinned_folders);
+    metadata_cache.save();
     config.save();
 
+    control_thread.stop();
+    control.close();
+    global_hotkeys.stop();
+    osc_server.stop();
+    web_server.stop();
+    audio_engine.stop();
+    folder_watcher.stop();
+    folder_scanner.stop();
+    sound_loader.stop();
+    scene_warmer.stop();
     CloseAudioDevice();
     CloseWindow();
 
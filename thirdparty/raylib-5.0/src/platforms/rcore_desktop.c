@@ -692,6 +692,14 @@ void SetWindowFocused(void)
     glfwFocusWindow(platform.handle);
 }
 
+// Wake up an EndDrawing() waiting for events
+// NOTE: Can be called from any thread
+void WakeEventWaiting(void)
+{
+    // Nothing to wake without a window, e.g. when only the audio module is used
+    if (CORE.Window.ready) glfwPostEmptyEvent();
+}
+
 // Get native window handle
 void *GetWindowHandle(void)
 {
@@ -1712,6 +1720,8 @@ static void KeyCallback(GLFWwindow *window, int key, int scancode, int action, i
 
     // Check the exit key to set close window
     if ((key == CORE.Input.Keyboard.exitKey) && (action == GLFW_PRESS)) glfwSetWindowShouldClose(platform.handle, GLFW_TRUE);
+
+    if ((keyEventCallback != NULL) && (action != GLFW_REPEAT)) keyEventCallback(key, (action == GLFW_PRESS));
 }
 
 // GLFW3 Char Key Callback, runs on key down (gets equivalent unicode char value)
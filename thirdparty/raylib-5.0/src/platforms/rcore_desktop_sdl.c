@@ -675,6 +675,12 @@ void SetWindowFocused(void)
     SDL_RaiseWindow(platform.window);
 }
 
+// Wake up an EndDrawing() waiting for events
+// NOTE: Event waiting is only supported on PLATFORM_DESKTOP, nothing to wake up here
+void WakeEventWaiting(void)
+{
+}
+
 // Get native window handle
 void *GetWindowHandle(void)
 {
@@ -318,6 +318,12 @@ void SetWindowFocused(void)
     TRACELOG(LOG_WARNING, "SetWindowFocused() not available on target platform");
 }
 
+// Wake up an EndDrawing() waiting for events
+// NOTE: Event waiting is only supported on PLATFORM_DESKTOP, nothing to wake up here
+void WakeEventWaiting(void)
+{
+}
+
 // Get native window handle
 void *GetWindowHandle(void)
 {
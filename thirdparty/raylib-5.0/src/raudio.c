@@ -294,6 +294,9 @@ typedef struct tagBITMAPINFOHEADER {
 #ifndef MAX_AUDIO_BUFFER_POOL_CHANNELS
     #define MAX_AUDIO_BUFFER_POOL_CHANNELS    16    // Audio pool channels
 #endif
+#ifndef MAX_AUDIO_VOICES
+    #define MAX_AUDIO_VOICES                  32    // Max streams playing at once, each one borrows a voice data block
+#endif
 
 //----------------------------------------------------------------------------------
 // Types and Structures Definition
@@ -324,9 +327,18 @@ typedef enum {
     MUSIC_AUDIO_MP3,        // MP3 audio context
     MUSIC_AUDIO_QOA,        // QOA audio context
     MUSIC_MODULE_XM,        // XM module audio context
-    MUSIC_MODULE_MOD        // MOD module audio context
+    MUSIC_MODULE_MOD,       // MOD module audio context
+    MUSIC_AUDIO_PCM         // Preloaded PCM context, already in device format
 } MusicContextType;
 
+// Preloaded PCM music context
+// NOTE: Data is stored in device format (AUDIO_DEVICE_FORMAT, AUDIO_DEVICE_CHANNELS, device sample rate)
+typedef struct PcmMusicContext {
+    void *data;                     // Converted frames
+    unsigned int frameCount;        // Total frames in data
+    unsigned int frameCursor;       // Next frame to be streamed
+} PcmMusicContext;
+
 // NOTE: Different logic is used when feeding data to the playback device
 // depending on whether data is streamed (Music vs Sound)
 typedef enum {
@@ -356,6 +368,8 @@ struct rAudioBuffer {
     unsigned int framesProcessed;   // Total frames processed in this buffer (required for play timing)
 
     unsigned char *data;            // Data buffer, on music stream keeps filling
+    int voice;                      // Voice slot lending the data buffer to a stream, -1 if none
+    bool tracked;                   // Audio buffer is linked on the mixing list
 
     rAudioBuffer *next;             // Next audio buffer on the list
     rAudioBuffer *prev;             // Previous audio buffer on the list
@@ -390,6 +404,11 @@ typedef struct AudioData {
         AudioBuffer *last;          // Pointer to last AudioBuffer in the list
         int defaultSize;            // Default audio buffer size for audio streams
     } Buffer;
+    struct {
+        unsigned char *data[MAX_AUDIO_VOICES];  // Voice data blocks, grown on demand and kept for reuse
+        unsigned int size[MAX_AUDIO_VOICES];    // Size in bytes of every voice data block
+        AudioBuffer *owner[MAX_AUDIO_VOICES];   // Stream buffer currently borrowing the voice, NULL if free
+    } Voice;
     rAudioProcessor* mixedProcessor;
 } AudioData;
 
@@ -412,6 +431,8 @@ static AudioData AUDIO = {          // Global AUDIO context
 static void OnLog(void *pUserData, ma_uint32 level, const char *pMessage);
 static void OnSendAudioDataToDevice(ma_device *pDevice, void *pFramesOut, const void *pFramesInput, ma_uint32 frameCount);
 static void MixAudioFrames(float *framesOut, const float *framesIn, ma_uint32 frameCount, AudioBuffer *buffer);
+static ma_uint64 ConvertFramesHighQuality(void *framesOut, ma_uint64 frameCountOut, ma_format formatOut, ma_uint32 channelsOut, ma_uint32 sampleRateOut, const void *framesIn, ma_uint64 frameCountIn, ma_format formatIn, ma_uint32 channelsIn, ma_uint32 sampleRateIn);
+static Music LoadMusicStreamFromWave(Wave wave, const char *fileName);
 
 #if defined(RAUDIO_STANDALONE)
 static bool IsFileExtension(const char *fileName, const char *ext); // Check file extension
@@ -439,6 +460,9 @@ void SetAudioBufferPitch(AudioBuffer *buffer, float pitch);
 void SetAudioBufferPan(AudioBuffer *buffer, float pan);
 void TrackAudioBuffer(AudioBuffer *buffer);
 void UntrackAudioBuffer(AudioBuffer *buffer);
+bool AcquireAudioBufferVoice(AudioBuffer *buffer);
+void ReleaseAudioBufferVoice(AudioBuffer *buffer);
+static void UnlinkAudioBuffer(AudioBuffer *buffer);
 
 //----------------------------------------------------------------------------------
 // Module Functions Definition - Audio Device initialization and Closing
@@ -548,6 +572,28 @@ void CloseAudioDevice(void)
         AUDIO.System.pcmBuffer = NULL;
         AUDIO.System.pcmBufferSize = 0;
 
+        // The device is stopped, streams still holding a voice are stopped and take a new one when played again
+        for (int i = 0; i < MAX_AUDIO_VOICES; i++)
+        {
+            AudioBuffer *owner = AUDIO.Voice.owner[i];
+
+            if (owner != NULL)
+            {
+                owner->playing = false;
+                owner->paused = false;
+                owner->frameCursorPos = 0;
+                owner->isSubBufferProcessed[0] = true;
+                owner->isSubBufferProcessed[1] = true;
+                owner->voice = -1;
+                owner->data = NULL;
+            }
+
+            RL_FREE(AUDIO.Voice.data[i]);
+            AUDIO.Voice.data[i] = NULL;
+            AUDIO.Voice.size[i] = 0;
+            AUDIO.Voice.owner[i] = NULL;
+        }
+
         TRACELOG(LOG_INFO, "AUDIO: Device closed successfully");
     }
     else TRACELOG(LOG_WARNING, "AUDIO: Device could not be closed, not currently initialized");
@@ -588,7 +634,9 @@ AudioBuffer *LoadAudioBuffer(ma_format format, ma_uint32 channels, ma_uint32 sam
         return NULL;
     }
 
-    if (sizeInFrames > 0) audioBuffer->data = RL_CALLOC(sizeInFrames*channels*ma_get_bytes_per_sample(format), 1);
+    // NOTE: Streams don't own their data, they borrow a voice from the pool while playing
+    if ((sizeInFrames > 0) && (usage == AUDIO_BUFFER_USAGE_STATIC)) audioBuffer->data = RL_CALLOC(sizeInFrames*channels*ma_get_bytes_per_sample(format), 1);
+    audioBuffer->voice = -1;
 
     // Audio data runs through a format converter
     ma_data_converter_config converterConfig = ma_data_converter_config_init(format, AUDIO_DEVICE_FORMAT, channels, AUDIO_DEVICE_CHANNELS, sampleRate, AUDIO.System.device.sampleRate);
@@ -624,8 +672,7 @@ AudioBuffer *LoadAudioBuffer(ma_format format, ma_uint32 channels, ma_uint32 sam
     audioBuffer->isSubBufferProcessed[0] = true;
     audioBuffer->isSubBufferProcessed[1] = true;
 
-    // Track audio buffer to linked list next position
-    TrackAudioBuffer(audioBuffer);
+    // NOTE: Audio buffer is only linked for mixing when played, see PlayAudioBuffer()
 
     return audioBuffer;
 }
@@ -637,7 +684,8 @@ void UnloadAudioBuffer(AudioBuffer *buffer)
     {
         ma_data_converter_uninit(&buffer->converter, NULL);
         UntrackAudioBuffer(buffer);
-        RL_FREE(buffer->data);
+        if (buffer->usage == AUDIO_BUFFER_USAGE_STREAM) ReleaseAudioBufferVoice(buffer);
+        else RL_FREE(buffer->data);
         RL_FREE(buffer);
     }
 }
@@ -662,6 +710,8 @@ void PlayAudioBuffer(AudioBuffer *buffer)
         buffer->playing = true;
         buffer->paused = false;
         buffer->frameCursorPos = 0;
+
+        TrackAudioBuffer(buffer);
     }
 }
 
@@ -726,9 +776,11 @@ void SetAudioBufferPan(AudioBuffer *buffer, float pan)
 }
 
 // Track audio buffer to linked list next position
+// NOTE: Only playing buffers are tracked, the mixer unlinks them once they stop
 void TrackAudioBuffer(AudioBuffer *buffer)
 {
     ma_mutex_lock(&AUDIO.System.lock);
+    if (!buffer->tracked)
     {
         if (AUDIO.Buffer.first == NULL) AUDIO.Buffer.first = buffer;
         else
@@ -738,6 +790,7 @@ void TrackAudioBuffer(AudioBuffer *buffer)
         }
 
         AUDIO.Buffer.last = buffer;
+        buffer->tracked = true;
     }
     ma_mutex_unlock(&AUDIO.System.lock);
 }
@@ -746,19 +799,106 @@ void TrackAudioBuffer(AudioBuffer *buffer)
 void UntrackAudioBuffer(AudioBuffer *buffer)
 {
     ma_mutex_lock(&AUDIO.System.lock);
+    UnlinkAudioBuffer(buffer);
+    ma_mutex_unlock(&AUDIO.System.lock);
+}
+
+// Borrow a voice data block for a stream buffer
+// NOTE: Blocks are grown to the largest stream that used them and never shrink,
+// so memory scales with the number of voices playing at once, not with loaded streams
+bool AcquireAudioBufferVoice(AudioBuffer *buffer)
+{
+    if (buffer->voice >= 0) return true;
+
+    int voice = -1;
+
+    ma_mutex_lock(&AUDIO.System.lock);
+    for (int i = 0; i < MAX_AUDIO_VOICES; i++)
+    {
+        if (AUDIO.Voice.owner[i] == NULL)
+        {
+            AUDIO.Voice.owner[i] = buffer;
+            voice = i;
+            break;
+        }
+    }
+    ma_mutex_unlock(&AUDIO.System.lock);
+
+    if (voice < 0)
+    {
+        TRACELOG(LOG_WARNING, "STREAM: All %i voices are playing, stream could not be started", MAX_AUDIO_VOICES);
+        return false;
+    }
+
+    // The voice is owned now, nothing else reads its block so it can be resized and cleared without the lock
+    unsigned int size = buffer->sizeInFrames*ma_get_bytes_per_frame(buffer->converter.formatIn, buffer->converter.channelsIn);
+
+    if (AUDIO.Voice.size[voice] < size)
+    {
+        RL_FREE(AUDIO.Voice.data[voice]);
+        AUDIO.Voice.data[voice] = RL_MALLOC(size);
+        AUDIO.Voice.size[voice] = (AUDIO.Voice.data[voice] != NULL)? size : 0;
+    }
+
+    bool allocated = (AUDIO.Voice.data[voice] != NULL);
+    if (allocated) memset(AUDIO.Voice.data[voice], 0, size);
+
+    // The mixer reads buffer->data under the lock, so the block is handed over (or the voice given back) under it too
+    ma_mutex_lock(&AUDIO.System.lock);
+    if (allocated)
+    {
+        buffer->data = AUDIO.Voice.data[voice];
+        buffer->voice = voice;
+    }
+    else AUDIO.Voice.owner[voice] = NULL;
+    ma_mutex_unlock(&AUDIO.System.lock);
+
+    if (!allocated)
     {
-        if (buffer->prev == NULL) AUDIO.Buffer.first = buffer->next;
-        else buffer->prev->next = buffer->next;
+        TRACELOG(LOG_WARNING, "STREAM: Failed to allocate voice data");
+        return false;
+    }
 
-        if (buffer->next == NULL) AUDIO.Buffer.last = buffer->prev;
-        else buffer->next->prev = buffer->prev;
+    return true;
+}
+
+// Return the voice borrowed by a stream buffer to the pool, stopping it
+void ReleaseAudioBufferVoice(AudioBuffer *buffer)
+{
+    if (buffer->voice < 0) return;
 
-        buffer->prev = NULL;
-        buffer->next = NULL;
+    ma_mutex_lock(&AUDIO.System.lock);
+    {
+        buffer->playing = false;
+        buffer->paused = false;
+        buffer->frameCursorPos = 0;
+        buffer->isSubBufferProcessed[0] = true;
+        buffer->isSubBufferProcessed[1] = true;
+
+        AUDIO.Voice.owner[buffer->voice] = NULL;
+        buffer->voice = -1;
+        buffer->data = NULL;
     }
     ma_mutex_unlock(&AUDIO.System.lock);
 }
 
+// Unlink audio buffer from the mixing list
+// NOTE: Caller must hold AUDIO.System.lock
+static void UnlinkAudioBuffer(AudioBuffer *buffer)
+{
+    if (!buffer->tracked) return;
+
+    if (buffer->prev == NULL) AUDIO.Buffer.first = buffer->next;
+    else buffer->prev->next = buffer->next;
+
+    if (buffer->next == NULL) AUDIO.Buffer.last = buffer->prev;
+    else buffer->next->prev = buffer->prev;
+
+    buffer->prev = NULL;
+    buffer->next = NULL;
+    buffer->tracked = false;
+}
+
 //----------------------------------------------------------------------------------
 // Module Functions Definition - Sounds loading and playing (.WAV)
 //----------------------------------------------------------------------------------
@@ -933,7 +1073,7 @@ Sound LoadSoundFromWave(Wave wave)
         ma_format formatIn = ((wave.sampleSize == 8)? ma_format_u8 : ((wave.sampleSize == 16)? ma_format_s16 : ma_format_f32));
         ma_uint32 frameCountIn = wave.frameCount;
 
-        ma_uint32 frameCount = (ma_uint32)ma_convert_frames(NULL, 0, AUDIO_DEVICE_FORMAT, AUDIO_DEVICE_CHANNELS, AUDIO.System.device.sampleRate, NULL, frameCountIn, formatIn, wave.channels, wave.sampleRate);
+        ma_uint32 frameCount = (ma_uint32)ConvertFramesHighQuality(NULL, 0, AUDIO_DEVICE_FORMAT, AUDIO_DEVICE_CHANNELS, AUDIO.System.device.sampleRate, NULL, frameCountIn, formatIn, wave.channels, wave.sampleRate);
         if (frameCount == 0) TRACELOG(LOG_WARNING, "SOUND: Failed to get frame count for format conversion");
 
         AudioBuffer *audioBuffer = LoadAudioBuffer(AUDIO_DEVICE_FORMAT, AUDIO_DEVICE_CHANNELS, AUDIO.System.device.sampleRate, frameCount, AUDIO_BUFFER_USAGE_STATIC);
@@ -943,7 +1083,7 @@ Sound LoadSoundFromWave(Wave wave)
             return sound; // early return to avoid dereferencing the audioBuffer null pointer
         }
 
-        frameCount = (ma_uint32)ma_convert_frames(audioBuffer->data, frameCount, AUDIO_DEVICE_FORMAT, AUDIO_DEVICE_CHANNELS, AUDIO.System.device.sampleRate, wave.data, frameCountIn, formatIn, wave.channels, wave.sampleRate);
+        frameCount = (ma_uint32)ConvertFramesHighQuality(audioBuffer->data, frameCount, AUDIO_DEVICE_FORMAT, AUDIO_DEVICE_CHANNELS, AUDIO.System.device.sampleRate, wave.data, frameCountIn, formatIn, wave.channels, wave.sampleRate);
         if (frameCount == 0) TRACELOG(LOG_WARNING, "SOUND: Failed format conversion");
 
         sound.frameCount = frameCount;
@@ -1705,6 +1845,64 @@ Music LoadMusicStreamFromMemory(const char *fileType, const unsigned char *data,
     return music;
 }
 
+// Load music stream from file, decoding it completely and converting it to device format
+// NOTE: Resampling is done once here with a high quality filter, so when pitch is 1.0f
+// the mixer can skip the data converter for this stream. Only meant for short clips.
+Music LoadMusicStreamPreloaded(const char *fileName)
+{
+    return LoadMusicStreamFromWave(LoadWave(fileName), fileName);
+}
+
+// Load music stream from memory buffer, decoding it completely and converting it to device format
+// NOTE: Same as LoadMusicStreamPreloaded(), the data is not referenced after this returns
+Music LoadMusicStreamPreloadedFromMemory(const char *fileType, const unsigned char *data, int dataSize)
+{
+    return LoadMusicStreamFromWave(LoadWaveFromMemory(fileType, data, dataSize), "memory");
+}
+
+// Converts the wave to device format and wraps it in a music stream, the wave is unloaded
+static Music LoadMusicStreamFromWave(Wave wave, const char *fileName)
+{
+    Music music = { 0 };
+
+    if (IsWaveReady(wave))
+    {
+        ma_format formatIn = ((wave.sampleSize == 8)? ma_format_u8 : ((wave.sampleSize == 16)? ma_format_s16 : ma_format_f32));
+        ma_uint32 sampleRate = AUDIO.System.device.sampleRate;
+
+        ma_uint64 frameCount = ConvertFramesHighQuality(NULL, 0, AUDIO_DEVICE_FORMAT, AUDIO_DEVICE_CHANNELS, sampleRate, NULL, wave.frameCount, formatIn, wave.channels, wave.sampleRate);
+        PcmMusicContext *ctxPcm = RL_CALLOC(1, sizeof(PcmMusicContext));
+        if (frameCount > 0) ctxPcm->data = RL_MALLOC((size_t)frameCount*ma_get_bytes_per_frame(AUDIO_DEVICE_FORMAT, AUDIO_DEVICE_CHANNELS));
+
+        if (ctxPcm->data != NULL)
+        {
+            ctxPcm->frameCount = (unsigned int)ConvertFramesHighQuality(ctxPcm->data, frameCount, AUDIO_DEVICE_FORMAT, AUDIO_DEVICE_CHANNELS, sampleRate, wave.data, wave.frameCount, formatIn, wave.channels, wave.sampleRate);
+        }
+
+        if (ctxPcm->frameCount > 0)
+        {
+            music.ctxType = MUSIC_AUDIO_PCM;
+            music.ctxData = ctxPcm;
+            music.stream = LoadAudioStream(sampleRate, 8*ma_get_bytes_per_sample(AUDIO_DEVICE_FORMAT), AUDIO_DEVICE_CHANNELS);
+            music.frameCount = ctxPcm->frameCount;
+            music.looping = true;   // Looping enabled by default
+
+            TRACELOG(LOG_INFO, "FILEIO: [%s] Music file preloaded successfully (%i Hz -> %i Hz, %i frames)", fileName, wave.sampleRate, sampleRate, music.frameCount);
+        }
+        else
+        {
+            RL_FREE(ctxPcm->data);
+            RL_FREE(ctxPcm);
+            TRACELOG(LOG_WARNING, "FILEIO: [%s] Music file could not be converted to device format", fileName);
+        }
+    }
+    else TRACELOG(LOG_WARNING, "FILEIO: [%s] Music file could not be preloaded", fileName);
+
+    UnloadWave(wave);
+
+    return music;
+}
+
 // Checks if a music stream is ready
 bool IsMusicReady(Music music)
 {
@@ -1744,6 +1942,7 @@ void UnloadMusicStream(Music music)
 #if defined(SUPPORT_FILEFORMAT_MOD)
         else if (music.ctxType == MUSIC_MODULE_MOD) { jar_mod_unload((jar_mod_context_t *)music.ctxData); RL_FREE(music.ctxData); }
 #endif
+        else if (music.ctxType == MUSIC_AUDIO_PCM) { RL_FREE(((PcmMusicContext *)music.ctxData)->data); RL_FREE(music.ctxData); }
     }
 }
 
@@ -1802,6 +2001,7 @@ void StopMusicStream(Music music)
 #if defined(SUPPORT_FILEFORMAT_MOD)
         case MUSIC_MODULE_MOD: jar_mod_seek_start((jar_mod_context_t *)music.ctxData); break;
 #endif
+        case MUSIC_AUDIO_PCM: ((PcmMusicContext *)music.ctxData)->frameCursor = 0; break;
         default: break;
     }
 }
@@ -1838,6 +2038,12 @@ void SeekMusicStream(Music music, float position)
 #if defined(SUPPORT_FILEFORMAT_FLAC)
         case MUSIC_AUDIO_FLAC: drflac_seek_to_pcm_frame((drflac *)music.ctxData, positionInFrames); break;
 #endif
+        case MUSIC_AUDIO_PCM:
+        {
+            PcmMusicContext *ctxPcm = (PcmMusicContext *)music.ctxData;
+            if (positionInFrames >= ctxPcm->frameCount) positionInFrames = 0;
+            ctxPcm->frameCursor = positionInFrames;
+        } break;
         default: break;
     }
 
@@ -1848,6 +2054,7 @@ void SeekMusicStream(Music music, float position)
 void UpdateMusicStream(Music music)
 {
     if (music.stream.buffer == NULL) return;
+    if (music.stream.buffer->data == NULL) return;  // Not playing, no voice to fill
 
     unsigned int subBufferSizeInFrames = music.stream.buffer->sizeInFrames/2;
 
@@ -1981,6 +2188,21 @@ void UpdateMusicStream(Music music)
 
             } break;
         #endif
+            case MUSIC_AUDIO_PCM:
+            {
+                PcmMusicContext *ctxPcm = (PcmMusicContext *)music.ctxData;
+                while (true)
+                {
+                    int frameCountRead = ctxPcm->frameCount - ctxPcm->frameCursor;
+                    if (frameCountRead > frameCountStillNeeded) frameCountRead = frameCountStillNeeded;
+                    memcpy((char *)AUDIO.System.pcmBuffer + frameCountReadTotal*frameSize, (char *)ctxPcm->data + ctxPcm->frameCursor*frameSize, frameCountRead*frameSize);
+                    ctxPcm->frameCursor += frameCountRead;
+                    frameCountReadTotal += frameCountRead;
+                    frameCountStillNeeded -= frameCountRead;
+                    if (frameCountStillNeeded == 0) break;
+                    else ctxPcm->frameCursor = 0;
+                }
+            } break;
             default: break;
         }
 
@@ -2124,7 +2346,8 @@ void UnloadAudioStream(AudioStream stream)
 // NOTE 2: To dequeue a buffer it needs to be processed: IsAudioStreamProcessed()
 void UpdateAudioStream(AudioStream stream, const void *data, int frameCount)
 {
-    if (stream.buffer != NULL)
+    // Filling a stream before playing it borrows its voice early
+    if ((stream.buffer != NULL) && AcquireAudioBufferVoice(stream.buffer))
     {
         if (stream.buffer->isSubBufferProcessed[0] || stream.buffer->isSubBufferProcessed[1])
         {
@@ -2182,7 +2405,7 @@ bool IsAudioStreamProcessed(AudioStream stream)
 // Play audio stream
 void PlayAudioStream(AudioStream stream)
 {
-    PlayAudioBuffer(stream.buffer);
+    if ((stream.buffer != NULL) && AcquireAudioBufferVoice(stream.buffer)) PlayAudioBuffer(stream.buffer);
 }
 
 // Play audio stream
@@ -2207,6 +2430,7 @@ bool IsAudioStreamPlaying(AudioStream stream)
 void StopAudioStream(AudioStream stream)
 {
     StopAudioBuffer(stream.buffer);
+    if (stream.buffer != NULL) ReleaseAudioBufferVoice(stream.buffer);
 }
 
 // Set volume for audio stream (1.0 is max level)
@@ -2458,6 +2682,17 @@ static ma_uint32 ReadAudioBufferFramesInMixingFormat(AudioBuffer *audioBuffer, f
     // should be defined by the output format of the data converter. We do this until frameCount frames have been output. The important
     // detail to remember here is that we never, ever attempt to read more input data than is required for the specified number of output
     // frames. This can be achieved with ma_data_converter_get_required_input_frame_count().
+    // Fast path: data is already in mixing format and no resampling is needed (e.g. preloaded music at pitch 1.0f),
+    // so the converter would only copy frames around. Read them straight into the output instead.
+    // NOTE: Pitch changes only adjust the resampler rate, converter.sampleRateOut keeps the device rate
+    if ((audioBuffer->converter.formatIn == ma_format_f32) && (audioBuffer->converter.formatOut == ma_format_f32) &&
+        (audioBuffer->converter.channelsIn == audioBuffer->converter.channelsOut) &&
+        (audioBuffer->converter.sampleRateIn == audioBuffer->converter.sampleRateOut) &&
+        (audioBuffer->pitch == 1.0f))
+    {
+        return ReadAudioBufferFramesInInternalFormat(audioBuffer, framesOut, frameCount);
+    }
+
     ma_uint8 inputBuffer[4096] = { 0 };
     ma_uint32 inputBufferFrameCap = sizeof(inputBuffer)/ma_get_bytes_per_frame(audioBuffer->converter.formatIn, audioBuffer->converter.channelsIn);
 
@@ -2511,10 +2746,21 @@ static void OnSendAudioDataToDevice(ma_device *pDevice, void *pFramesOut, const
     // This is unlikely to be necessary for this project, but may want to consider how you might want to avoid this
     ma_mutex_lock(&AUDIO.System.lock);
     {
-        for (AudioBuffer *audioBuffer = AUDIO.Buffer.first; audioBuffer != NULL; audioBuffer = audioBuffer->next)
+        // NOTE: Only played buffers are on the list, stopped ones get unlinked here so the
+        // walk scales with the voices in use and not with every loaded sound
+        AudioBuffer *nextBuffer = NULL;
+        for (AudioBuffer *audioBuffer = AUDIO.Buffer.first; audioBuffer != NULL; audioBuffer = nextBuffer)
         {
-            // Ignore stopped or paused sounds
-            if (!audioBuffer->playing || audioBuffer->paused) continue;
+            nextBuffer = audioBuffer->next;
+
+            if (!audioBuffer->playing)
+            {
+                UnlinkAudioBuffer(audioBuffer);
+                continue;
+            }
+
+            // Ignore paused sounds
+            if (audioBuffer->paused) continue;
 
             ma_uint32 framesRead = 0;
 
@@ -2596,6 +2842,16 @@ static void OnSendAudioDataToDevice(ma_device *pDevice, void *pFramesOut, const
     ma_mutex_unlock(&AUDIO.System.lock);
 }
 
+// Convert frames in one go with the highest quality low-pass filter the linear resampler supports
+// NOTE: Same as ma_convert_frames(), only used at load time so the extra filtering cost is fine
+static ma_uint64 ConvertFramesHighQuality(void *framesOut, ma_uint64 frameCountOut, ma_format formatOut, ma_uint32 channelsOut, ma_uint32 sampleRateOut, const void *framesIn, ma_uint64 frameCountIn, ma_format formatIn, ma_uint32 channelsIn, ma_uint32 sampleRateIn)
+{
+    ma_data_converter_config config = ma_data_converter_config_init(formatIn, formatOut, channelsIn, channelsOut, sampleRateIn, sampleRateOut);
+    config.resampling.linear.lpfOrder = MA_MAX_FILTER_ORDER;
+
+    return ma_convert_frames_ex(framesOut, frameCountOut, framesIn, frameCountIn, &config);
+}
+
 // Main mixing function, pretty simple in this project, just an accumulation
 // NOTE: framesOut is both an input and an output, it is initially filled with zeros outside of this function
 static void MixAudioFrames(float *framesOut, const float *framesIn, ma_uint32 frameCount, AudioBuffer *buffer)
@@ -94,6 +94,7 @@
 #include <stdlib.h>                 // Required for: srand(), rand(), atexit()
 #include <stdio.h>                  // Required for: sprintf() [Used in OpenURL()]
 #include <string.h>                 // Required for: strrchr(), strcmp(), strlen(), memset()
+#include <ctype.h>                  // Required for: tolower() [Used in IsFileExtension()]
 #include <time.h>                   // Required for: time() [Used in InitTimer()]
 #include <math.h>                   // Required for: tan() [Used in BeginMode3D()], atan2f() [Used in LoadVrStereoConfig()]
 
@@ -441,6 +442,8 @@ struct AutomationEvent {
 };
 */
 
+static KeyEventCallback keyEventCallback = NULL;            // Key event callback, set by user
+
 static AutomationEventList *currentEventList = NULL;        // Current automation events list, set by user, keep internal pointer
 static bool automationEventRecording = false;               // Recording automation events flag
 //static short automationEventEnabled = 0b0000001111111111; // TODO: Automation events enabled for recording/playing
@@ -789,6 +792,13 @@ void DisableEventWaiting(void)
     CORE.Window.eventWaiting = false;
 }
 
+// Set key event callback
+// NOTE: Only called by platforms that receive key events as callbacks (desktop)
+void SetKeyEventCallback(KeyEventCallback callback)
+{
+    keyEventCallback = callback;
+}
+
 // Check if cursor is not visible
 bool IsCursorHidden(void)
 {
@@ -1829,31 +1839,36 @@ bool FileExists(const char *fileName)
 // NOTE: Extensions checking is not case-sensitive
 bool IsFileExtension(const char *fileName, const char *ext)
 {
-    #define MAX_FILE_EXTENSION_SIZE  16
-
     bool result = false;
     const char *fileExt = GetFileExtension(fileName);
 
     if (fileExt != NULL)
     {
-#if defined(SUPPORT_MODULE_RTEXT) && defined(SUPPORT_TEXT_MANIPULATION)
-        int extCount = 0;
-        const char **checkExts = TextSplit(ext, ';', &extCount); // WARNING: Module required: rtext
-
-        char fileExtLower[MAX_FILE_EXTENSION_SIZE + 1] = { 0 };
-        strncpy(fileExtLower, TextToLower(fileExt), MAX_FILE_EXTENSION_SIZE); // WARNING: Module required: rtext
+        // NOTE: Extensions are compared in place instead of using TextSplit()/TextToLower(),
+        // their static buffers are not safe when files are loaded from several threads
+        int fileExtLength = (int)strlen(fileExt);
+        const char *checkExt = ext;
 
-        for (int i = 0; i < extCount; i++)
+        while (*checkExt != '\0')
         {
-            if (strcmp(fileExtLower, TextToLower(checkExts[i])) == 0)
+            int checkExtLength = 0;
+            while ((checkExt[checkExtLength] != '\0') && (checkExt[checkExtLength] != ';')) checkExtLength++;
+
+            if (checkExtLength == fileExtLength)
             {
-                result = true;
-                break;
+                int i = 0;
+                while ((i < checkExtLength) && (tolower((unsigned char)fileExt[i]) == tolower((unsigned char)checkExt[i]))) i++;
+
+                if (i == checkExtLength)
+                {
+                    result = true;
+                    break;
+                }
             }
+
+            checkExt += checkExtLength;
+            if (*checkExt == ';') checkExt++;
         }
-#else
-        if (strcmp(fileExt, ext) == 0) result = true;
-#endif
     }
 
     return result;